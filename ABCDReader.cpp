@@ -13,128 +13,133 @@
 #include "DataSample.h"
 #include "ABCDReader.h"
 #include "AbcdBase.h"
-#include <string>;
+#include "RunTrace.h"
+#include <string>
 
 ClassImp(ABCDReader)
 
-ABCDReader::ABCDReader(DataSample* sample, TString mode, int jet_bin,
+ABCDReader::ABCDReader(const DataSample* sample, TString mode, int jet_bin,
 		bool is_inclusive, int sys_mode) :
 		sample_(sample), //
-		nA_(0.), nB_(0.), nC_(0.), nD_(0.), //
-		nAError_(0.), nBError_(0.), nCError_(0.), nDError_(0.), isZombie_(0), mode_(
-				mode), jet_bin_(jet_bin), is_inclusive_(is_inclusive), sys_mode_(
-				sys_mode) //
+		table_(0), //
+		isZombie_(0), mode_(mode), mode_index_(-1), jet_bin_(jet_bin), is_inclusive_(
+				is_inclusive), sys_mode_(sys_mode), first_bin_(0), last_bin_(0), syst_factor_(
+				1.), cube_(0) //
 {
-	this->setRegionIntegralsAndErrors();
+	TraceSpan span("reader", "ABCDReader", sample_->GetSampleName().Data());
+	table_ = sample_->GetYieldTable();
+	mode_index_ = table_->GetModeIndex(mode_);
+	if (mode_index_ < 0) {
+		std::cout << "ABCDReader::ABCDReader - Unknown mode " << mode_
+				<< std::endl;
+		exit(-1);
+	}
+	table_->GetBinRange(jet_bin_, is_inclusive_, first_bin_, last_bin_);
+	syst_factor_ = this->GetSystFactor();
+}
+
+ABCDReader::ABCDReader(const DataSample* sample, TString mode, int jet_bin,
+		bool is_inclusive, int sys_mode, double met_cut, double iso_cut) :
+		sample_(sample), //
+		table_(0), //
+		isZombie_(0), mode_(mode), mode_index_(-1), jet_bin_(jet_bin), is_inclusive_(
+				is_inclusive), sys_mode_(sys_mode), first_bin_(0), last_bin_(0), syst_factor_(
+				1.), cube_(0) //
+{
+	TraceSpan span("reader", "ABCDReader", sample_->GetSampleName().Data());
+	cube_ = sample_->GetRegionCube(mode_);
+	if (cube_ == 0) {
+		std::cout << "ABCDReader::ABCDReader - No "
+				<< sample_->GetRegionCubeName(mode_) << " for "
+				<< sample_->GetSampleName() << std::endl;
+		exit(-1);
+	}
+	for (int region = AbcdBase::A; region <= AbcdBase::D; region++) {
+		boxes_.push_back(
+				cube_->GetRegionBox(region, jet_bin_, is_inclusive_, met_cut,
+						iso_cut));
+	}
+	syst_factor_ = this->GetSystFactor();
 }
 
 ABCDReader::~ABCDReader() {
-	nA_ = 0.;
-	nB_ = 0.;
-	nC_ = 0.;
-	nD_ = 0.;
-	nAError_ = 0.;
-	nBError_ = 0.;
-	nCError_ = 0.;
-	nDError_ = 0.;
 	isZombie_ = 1;
 	mode_ = "";
-	delete sample_;
+	table_ = 0;
+	cube_ = 0;
+	sample_ = 0;
 }
 
-void ABCDReader::setRegionIntegralsAndErrors() {
-	nA_ = this->GetYieldFromSample(0);
-	nB_ = this->GetYieldFromSample(1);
-	nC_ = this->GetYieldFromSample(2);
-	nD_ = this->GetYieldFromSample(3);
-
-	nAError_ = this->GetYieldErrorFromSample(0);
-	nBError_ = this->GetYieldErrorFromSample(1);
-	nCError_ = this->GetYieldErrorFromSample(2);
-	nDError_ = this->GetYieldErrorFromSample(3);
+// Returns nD estimate for this ABCDReader object, without the syst factor
+const double ABCDReader::GetNdEstimate() const {
+	double yield_A = this->GetRawYield(AbcdBase::A);
+	double yield_B = this->GetRawYield(AbcdBase::B);
+	double yield_C = this->GetRawYield(AbcdBase::C);
+	return (yield_B * yield_C) / yield_A;
+}
+/*----------------------------------------------*/
 
-	return;
+double ABCDReader::GetRawYield(int region) const {
+	if (cube_ != 0)
+		return cube_->GetYield(boxes_[region - 1]);
+	return table_->GetYield(mode_index_, region, first_bin_, last_bin_);
 }
 
-// Returns nD estimate for this ABCDReader object
-const double ABCDReader::GetNdEstimate() {
-	return (nB_ * nC_) / (nA_);
+double ABCDReader::GetRawSumw2(int region) const {
+	if (cube_ != 0)
+		return cube_->GetSumw2(boxes_[region - 1]);
+	return table_->GetSumw2(mode_index_, region, first_bin_, last_bin_);
 }
-/*----------------------------------------------*/
 
-// returns the region integral
-double ABCDReader::GetRegionYield(int region) {
+// returns the region integral, regions count from AbcdBase::A
+double ABCDReader::GetRegionYield(int region) const {
 
 	double regionValue = 0;
 
-	switch (region) {
-	case (AbcdBase::A):
-		regionValue = nA_;
-		break;
-	case (AbcdBase::B):
-		regionValue = nB_;
-		break;
-	case (AbcdBase::C):
-		regionValue = nC_;
-		break;
-	case (AbcdBase::D):
-		regionValue = nD_;
-		break;
-	}
+	if (region >= 1 && region <= (int) this->GetNRegions())
+		regionValue = this->GetRawYield(region);
 
-	regionValue *= this->GetSystFactor();
+	regionValue *= syst_factor_;
 
 	return regionValue;
 }
 
 // returns the integral error in
-double ABCDReader::GetRegionError(int region) {
+double ABCDReader::GetRegionError(int region) const {
 	double regionError = 0;
 
-	switch (region) {
-	case (AbcdBase::A):
-		regionError = nAError_;
-		break;
-	case (AbcdBase::B):
-		regionError = nBError_;
-		break;
-	case (AbcdBase::C):
-		regionError = nCError_;
-		break;
-	case (AbcdBase::D):
-		regionError = nDError_;
-		break;
-	}
+	if (region >= 1 && region <= (int) this->GetNRegions())
+		regionError = sqrt(this->GetRawSumw2(region));
 
 	return regionError;
 }
 
-// Grabs Yields from histogram
-const double ABCDReader::GetYieldFromSample(int region) {
-	return sample_->GetYield(mode_, region, jet_bin_, is_inclusive_);
-} // End of GetYieldFromSample
-
-const double ABCDReader::GetYieldErrorFromSample(int region) {
-	return sample_->GetYieldError(mode_, region, jet_bin_, is_inclusive_);
-} // End of GetYieldErrorFromSample
-
-double ABCDReader::GetSystFactor() {
-	double factor = 1.;
-	double error = 0.;
+double ABCDReader::GetSystFactor() const {
 #ifdef DEBUG
 	std::cout << "ABCDReader::GetSystFactor - Systematic: " << sys_mode_
 			<< std::endl;
 	std::cout << "ABCDReader::GetSystFactor - Sample Name: "
 			<< sample_->GetSampleName() << std::endl;
 #endif
-	if (sample_->GetSampleName().Contains("ttbar"))
+	return GetSampleSystFactor(sample_->GetSampleName(), sys_mode_);
+}
+
+double ABCDReader::GetSampleNormError(TString sample_name) {
+	double error = 0.;
+	if (sample_name.Contains("ttbar"))
 		error = 0.15;
-	else if (sample_->GetSampleName().Contains("WJetsScaled"))
+	else if (sample_name.Contains("WJetsScaled"))
 		error = 0.25;
+	return error;
+}
+
+double ABCDReader::GetSampleSystFactor(TString sample_name, int sys_mode) {
+	double factor = 1.;
+	double error = GetSampleNormError(sample_name);
 
-	if (sys_mode_ == 0) {
+	if (sys_mode == 0) {
 		factor -= error;
-	} else if (sys_mode_ == 2) {
+	} else if (sys_mode == 2) {
 		factor += error;
 	} else {
 		factor = 1.;
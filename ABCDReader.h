@@ -11,43 +11,70 @@
 #define ABCDREADER_H_
 
 #include <vector>
+#include <map>
 #include "TString.h"
 #include "DataSample.h"
+#include "RegionYieldTable.h"
+#include "RegionCube.h"
 
 class ABCDReader {
 
 private:
-	DataSample* sample_;
-	double nA_;
-	double nB_;
-	double nC_;
-	double nD_;
-	double nAError_;
-	double nBError_;
-	double nCError_;
-	double nDError_;
+	const DataSample* sample_;
+	// Shared by every reader of the sample, owned by the sample
+	const RegionYieldTable* table_; //!
 	int isZombie_;
 	TString mode_;
+	int mode_index_;
 	int jet_bin_;
 	bool is_inclusive_;
 	int sys_mode_;
+	// Histogram bins of the jet selection
+	int first_bin_;
+	int last_bin_;
+	double syst_factor_;
+	// Set when the regions are cut from the sample's cube instead, A to D
+	const RegionCube* cube_; //!
+	std::vector<RegionCube::Box> boxes_;
 
-	void setRegionIntegralsAndErrors();
+	// Readers are views, copying one is never needed
+	ABCDReader(const ABCDReader&);
+	ABCDReader& operator=(const ABCDReader&);
 
-	const double GetYieldFromSample(int region);
-	const double GetYieldErrorFromSample(int region);
-	double GetSystFactor(void);
+	double GetSystFactor(void) const;
+	double GetRawYield(int region) const;
+	double GetRawSumw2(int region) const;
 
 public:
-	ABCDReader(DataSample* sample, TString mode, int jet_bin, bool is_inclusive,
+	// The sample is not owned, it has to outlive the reader. A reader
+	// only reads the shared yield table once built, so one reader can be
+	// used from any number of threads.
+	ABCDReader(const DataSample* sample, TString mode, int jet_bin, bool is_inclusive,
 			int sys_mode);
+	// Regions cut from the njet x MET x etcone20 cube of the sample, see
+	// DataSample::UseRegionCubes: A and B below met_cut, A and C with
+	// etcone20 above iso_cut
+	ABCDReader(const DataSample* sample, TString mode, int jet_bin, bool is_inclusive,
+			int sys_mode, double met_cut, double iso_cut);
 	virtual ~ABCDReader(void);
-	double GetRegionYield(int region);
-	double GetRegionError(int region);
+	double GetRegionYield(int region) const;
+	double GetRegionError(int region) const;
 
-	const double GetNdEstimate(void);
+	const double GetNdEstimate(void) const;
+
+	// Normalisation uncertainty of a sample and the factor applied to
+	// its yields for a given sys_mode (0 down, 1 nominal, 2 up)
+	static double GetSampleNormError(TString sample_name);
+	static double GetSampleSystFactor(TString sample_name, int sys_mode);
+
+	unsigned int GetNRegions(void) const {
+		return (cube_ != 0) ? boxes_.size() : table_->GetNRegions();
+	}
 
 ClassDef(ABCDReader,1)
 
 };
+
+typedef std::map<TString, ABCDReader*> ReaderCollection;
+
 #endif /* ABCDReader_H_ */
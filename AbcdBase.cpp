@@ -12,19 +12,18 @@
 
 ClassImp(AbcdBase)
 
-AbcdBase* AbcdBase::baseInst = new AbcdBase();
-std::string AbcdBase::labelEtcone20 = "E_{T}^{cone20} [GeV]";
-std::string AbcdBase::labelMet = "E_{T}^{miss} [GeV]";
-std::string AbcdBase::labelIsolation = "Isolation";
-TString AbcdBase::pm = "<latex size=SMALL>\\pm</latex>";
+const std::string AbcdBase::labelEtcone20 = "E_{T}^{cone20} [GeV]";
+const std::string AbcdBase::labelMet = "E_{T}^{miss} [GeV]";
+const std::string AbcdBase::labelIsolation = "Isolation";
+const char* const AbcdBase::pm = "<latex size=SMALL>\\pm</latex>";
 
-void AbcdBase::drawLine() {
+void AbcdBase::drawLine() const {
 	std::cout << "----------------------------------------------------"
 			<< std::endl;
 }
 
 // Extra functions for testing validity of files
-void AbcdBase::isDeadFile(TFile* file) {
+void AbcdBase::isDeadFile(TFile* file) const {
 	if (file->IsZombie()) {
 		std::cout << "Sample file NOT found" << std::endl;
 		exit(-1);
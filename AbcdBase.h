@@ -1,5 +1,7 @@
 /*
  * AbcdBase.h
+ * Region and dimension enums and the shared labels. Everything static is
+ * constant once the library is loaded, so it can be read from any thread.
  *
  *  Created on: Dec 9, 2011
  *      Author: jayb88
@@ -21,18 +23,16 @@ private:
 
 public:
 
-	static AbcdBase* baseInst;
-
-	static std::string labelMet;
-	static std::string labelEtcone20;
-	static std::string labelIsolation;
+	static const std::string labelMet;
+	static const std::string labelEtcone20;
+	static const std::string labelIsolation;
 
 	AbcdBase() {
 	}
 	virtual ~AbcdBase() {
 	}
-	void isDeadFile(TFile* file);
-	void drawLine(void);
+	void isDeadFile(TFile* file) const;
+	void drawLine(void) const;
 
 	typedef enum {
 		A = 1, B = 2, C = 3, D = 4
@@ -41,7 +41,8 @@ public:
 		MET = 1, ETCONE20 = 2
 	} DimensionEnum;
 
-	static TString pm;
+	// Plus-minus sign of the TWiki tables
+	static const char* const pm;
 
 
 ClassDef(AbcdBase, 1)
@@ -0,0 +1,269 @@
+/*
+ * BinnedLikelihood.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include "BinnedLikelihood.h"
+#include "ParallelFor.h"
+#include <iostream>
+#include <math.h>
+
+namespace {
+
+// Solves a x = b in place for a small dense symmetric positive matrix,
+// a is replaced by its inverse. Returns false if a is singular.
+bool InvertAndSolve(std::vector<double>& a, std::vector<double>& b,
+		unsigned int n) {
+	std::vector<double> inverse(n * n, 0.);
+	for (unsigned int row = 0; row != n; row++) {
+		inverse[row * n + row] = 1.;
+	}
+
+	for (unsigned int col = 0; col != n; col++) {
+		unsigned int pivot = col;
+		for (unsigned int row = col + 1; row != n; row++) {
+			if (fabs(a[row * n + col]) > fabs(a[pivot * n + col]))
+				pivot = row;
+		}
+		if (a[pivot * n + col] == 0.)
+			return false;
+
+		for (unsigned int k = 0; k != n; k++) {
+			std::swap(a[col * n + k], a[pivot * n + k]);
+			std::swap(inverse[col * n + k], inverse[pivot * n + k]);
+		}
+		std::swap(b[col], b[pivot]);
+
+		double scale = 1. / a[col * n + col];
+		for (unsigned int k = 0; k != n; k++) {
+			a[col * n + k] *= scale;
+			inverse[col * n + k] *= scale;
+		}
+		b[col] *= scale;
+
+		for (unsigned int row = 0; row != n; row++) {
+			if (row == col)
+				continue;
+			double factor = a[row * n + col];
+			for (unsigned int k = 0; k != n; k++) {
+				a[row * n + k] -= factor * a[col * n + k];
+				inverse[row * n + k] -= factor * inverse[col * n + k];
+			}
+			b[row] -= factor * b[col];
+		}
+	}
+
+	a = inverse;
+	return true;
+}
+
+} // End anonymous namespace
+
+BinnedLikelihood::BinnedLikelihood(const std::vector<double>& observed) :
+		n_bins_(observed.size()), observed_(observed), fixed_(observed.size(),
+				0.) {
+}
+
+BinnedLikelihood::~BinnedLikelihood() {
+}
+
+unsigned int BinnedLikelihood::AddTemplate(
+		const std::vector<double>& bin_contents, double constraint_width) {
+	templates_.insert(templates_.end(), bin_contents.begin(),
+			bin_contents.begin() + n_bins_);
+	constraint_widths_.push_back(constraint_width);
+	return constraint_widths_.size() - 1;
+}
+
+void BinnedLikelihood::AddFixed(const std::vector<double>& bin_contents) {
+	for (unsigned int bin = 0; bin != n_bins_; bin++) {
+		fixed_[bin] += bin_contents[bin];
+	}
+}
+
+void BinnedLikelihood::EvaluateChunk(unsigned int first_bin,
+		unsigned int last_bin, const std::vector<double>& params, double& nll,
+		std::vector<double>& gradient, std::vector<double>& hessian) const {
+	unsigned int n_params = this->GetNParameters();
+	unsigned int n = last_bin - first_bin;
+	const double* observed = &observed_[first_bin];
+
+	// Expected counts
+	std::vector<double> expected(fixed_.begin() + first_bin,
+			fixed_.begin() + last_bin);
+	for (unsigned int param = 0; param != n_params; param++) {
+		const double* shape = &templates_[param * n_bins_ + first_bin];
+		const double scale = params[param];
+		for (unsigned int bin = 0; bin != n; bin++) {
+			expected[bin] += scale * shape[bin];
+		}
+	}
+
+	// -ln L up to a constant, empty bins only contribute their expectation.
+	// Bins with nothing expected, e.g. where a template is clipped at 0,
+	// add nothing to the gradient and Hessian instead of 0/0.
+	std::vector<double> ratio(n);
+	std::vector<double> weight(n);
+	nll = 0.;
+	for (unsigned int bin = 0; bin != n; bin++) {
+		const double nu = expected[bin];
+		const double obs = observed[bin];
+		const double inv_nu = (nu > 0.) ? 1. / nu : 0.;
+		const double log_term = (obs > 0.) ? obs * log(obs / nu) : 0.;
+		nll += nu - obs + log_term;
+		ratio[bin] = (nu > 0.) ? 1. - obs * inv_nu : 0.;
+		weight[bin] = obs * inv_nu * inv_nu;
+	}
+
+	gradient.assign(n_params, 0.);
+	hessian.assign(n_params * n_params, 0.);
+	for (unsigned int param = 0; param != n_params; param++) {
+		const double* shape = &templates_[param * n_bins_ + first_bin];
+		double sum = 0.;
+		for (unsigned int bin = 0; bin != n; bin++) {
+			sum += shape[bin] * ratio[bin];
+		}
+		gradient[param] = sum;
+
+		for (unsigned int other = 0; other <= param; other++) {
+			const double* other_shape =
+					&templates_[other * n_bins_ + first_bin];
+			double cross = 0.;
+			for (unsigned int bin = 0; bin != n; bin++) {
+				cross += shape[bin] * other_shape[bin] * weight[bin];
+			}
+			hessian[param * n_params + other] = cross;
+			hessian[other * n_params + param] = cross;
+		}
+	}
+}
+
+double BinnedLikelihood::Evaluate(const std::vector<double>& params,
+		std::vector<double>& gradient, std::vector<double>& hessian) const {
+	unsigned int n_params = this->GetNParameters();
+	unsigned int n_chunks = (n_bins_ + kChunkSize - 1) / kChunkSize;
+	if (n_chunks == 0)
+		n_chunks = 1;
+
+	std::vector<double> chunk_nll(n_chunks, 0.);
+	std::vector<std::vector<double> > chunk_gradient(n_chunks);
+	std::vector<std::vector<double> > chunk_hessian(n_chunks);
+
+	if (n_bins_ >= kParallelBins) {
+		ParallelFor(n_chunks, [&](unsigned int chunk) {
+			unsigned int first_bin = chunk * kChunkSize;
+			unsigned int last_bin = std::min(first_bin + kChunkSize, n_bins_);
+			this->EvaluateChunk(first_bin, last_bin, params, chunk_nll[chunk],
+					chunk_gradient[chunk], chunk_hessian[chunk]);
+		});
+	} else {
+		for (unsigned int chunk = 0; chunk != n_chunks; chunk++) {
+			unsigned int first_bin = chunk * kChunkSize;
+			unsigned int last_bin = std::min(first_bin + kChunkSize, n_bins_);
+			this->EvaluateChunk(first_bin, last_bin, params, chunk_nll[chunk],
+					chunk_gradient[chunk], chunk_hessian[chunk]);
+		}
+	}
+
+	// Chunks are added in order whatever thread computed them
+	double nll = 0.;
+	gradient.assign(n_params, 0.);
+	hessian.assign(n_params * n_params, 0.);
+	for (unsigned int chunk = 0; chunk != n_chunks; chunk++) {
+		nll += chunk_nll[chunk];
+		for (unsigned int param = 0; param != n_params; param++) {
+			gradient[param] += chunk_gradient[chunk][param];
+		}
+		for (unsigned int entry = 0; entry != n_params * n_params; entry++) {
+			hessian[entry] += chunk_hessian[chunk][entry];
+		}
+	}
+
+	// Gaussian constraints around 1
+	for (unsigned int param = 0; param != n_params; param++) {
+		double width = constraint_widths_[param];
+		if (width <= 0.)
+			continue;
+		double pull = (params[param] - 1.) / width;
+		nll += 0.5 * pull * pull;
+		gradient[param] += pull / width;
+		hessian[param * n_params + param] += 1. / (width * width);
+	}
+
+	return nll;
+}
+
+bool BinnedLikelihood::Minimise(std::vector<double>& params,
+		std::vector<double>& covariance) const {
+	unsigned int n_params = this->GetNParameters();
+	std::vector<double> gradient;
+	std::vector<double> hessian;
+	std::vector<double> trial_gradient;
+	std::vector<double> trial_hessian;
+	covariance.clear();
+
+	double nll = this->Evaluate(params, gradient, hessian);
+	bool converged = false;
+
+	for (int iteration = 0; iteration != 100 && !converged; iteration++) {
+		std::vector<double> step = gradient;
+		std::vector<double> inverse = hessian;
+		if (!InvertAndSolve(inverse, step, n_params)) {
+			std::cout << "BinnedLikelihood::Minimise - Singular Hessian"
+					<< std::endl;
+			return false;
+		}
+
+		// Halve the Newton step until the fit improves
+		double fraction = 1.;
+		bool improved = false;
+		std::vector<double> trial(n_params);
+		for (int halving = 0; halving != 30 && !improved; halving++) {
+			for (unsigned int param = 0; param != n_params; param++) {
+				trial[param] = params[param] - fraction * step[param];
+			}
+			double trial_nll = this->Evaluate(trial, trial_gradient,
+					trial_hessian);
+			if (trial_nll == trial_nll && trial_nll <= nll) {
+				converged = (nll - trial_nll) < 1e-10 * (1. + fabs(nll));
+				improved = true;
+				params = trial;
+				nll = trial_nll;
+				gradient = trial_gradient;
+				hessian = trial_hessian;
+			}
+			fraction /= 2.;
+		}
+		// No step helps: a minimum if the gradient vanishes, else the
+		// likelihood cannot be evaluated along the step, e.g. NaN
+		if (!improved) {
+			double norm = 0.;
+			for (unsigned int param = 0; param != n_params; param++) {
+				norm += gradient[param] * gradient[param];
+			}
+			if (!(sqrt(norm) <= 1e-6 * (1. + fabs(nll)))) {
+				std::cout << "BinnedLikelihood::Minimise - No step improves "
+						<< "the fit, gradient " << sqrt(norm) << std::endl;
+				return false;
+			}
+			converged = true;
+		}
+	}
+
+	if (!converged) {
+		std::cout << "BinnedLikelihood::Minimise - No convergence after "
+				<< "100 iterations" << std::endl;
+		return false;
+	}
+
+	std::vector<double> inverse = hessian;
+	std::vector<double> unused(n_params, 0.);
+	if (!InvertAndSolve(inverse, unused, n_params)) {
+		std::cout << "BinnedLikelihood::Minimise - Singular Hessian at the "
+				<< "minimum" << std::endl;
+		return false;
+	}
+	covariance = inverse;
+	return true;
+}
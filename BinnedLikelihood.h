@@ -0,0 +1,66 @@
+/*
+ * BinnedLikelihood.h
+ * Poisson likelihood of observed bin counts given a sum of templates,
+ * each scaled by a fit parameter, plus a fixed background. Parameters
+ * can be free or carry a Gaussian constraint around 1.
+ *
+ * The bins are processed in fixed chunks with the per-chunk partial sums
+ * added in chunk order, so large histograms are reduced in parallel and
+ * the result does not depend on the number of threads. The inner loops
+ * run over contiguous arrays and have no branches so they vectorise.
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef BINNEDLIKELIHOOD_H_
+#define BINNEDLIKELIHOOD_H_
+
+#include <vector>
+
+class BinnedLikelihood {
+
+private:
+	unsigned int n_bins_;
+	std::vector<double> observed_;
+	std::vector<double> fixed_;
+	// One row of n_bins_ per parameter
+	std::vector<double> templates_;
+	std::vector<double> constraint_widths_;
+
+	static const unsigned int kChunkSize = 1024;
+	static const unsigned int kParallelBins = 8 * kChunkSize;
+
+	void EvaluateChunk(unsigned int first_bin, unsigned int last_bin,
+			const std::vector<double>& params, double& nll,
+			std::vector<double>& gradient, std::vector<double>& hessian) const;
+
+public:
+	BinnedLikelihood(const std::vector<double>& observed);
+	virtual ~BinnedLikelihood();
+
+	// Returns the parameter index. constraint_width = 0 leaves it free.
+	unsigned int AddTemplate(const std::vector<double>& bin_contents,
+			double constraint_width = 0.);
+	// Background that is not fitted
+	void AddFixed(const std::vector<double>& bin_contents);
+
+	unsigned int GetNParameters(void) const {
+		return constraint_widths_.size();
+	}
+	unsigned int GetNBins(void) const {
+		return n_bins_;
+	}
+
+	// Negative log likelihood, shifted so that it is 0 for a perfect fit,
+	// with its gradient and Hessian (row major)
+	double Evaluate(const std::vector<double>& params,
+			std::vector<double>& gradient, std::vector<double>& hessian) const;
+
+	// Newton minimisation starting from params. The covariance is the
+	// inverse Hessian at the minimum. Returns false, with the covariance
+	// left empty, if it did not converge or the Hessian is singular.
+	bool Minimise(std::vector<double>& params,
+			std::vector<double>& covariance) const;
+};
+
+#endif /* BINNEDLIKELIHOOD_H_ */
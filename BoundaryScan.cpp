@@ -0,0 +1,241 @@
+/*
+ * BoundaryScan.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include "BoundaryScan.h"
+#include "AbcdBase.h"
+#include "ParallelFor.h"
+#include "TFile.h"
+#include "TH2D.h"
+#include <iostream>
+#include <math.h>
+
+BoundaryScan::BoundaryScan(TString mode, int jet_bin, bool is_inclusive) :
+		sample_set_(0), owns_sample_set_(true), mode_(mode), jet_bin_(
+				jet_bin), is_inclusive_(is_inclusive), n_met_cells_(0), n_iso_cells_(
+				0), binning_(0) {
+	sample_set_ = new SampleSet(
+			GetSampleSetup(mode_, jet_bin_, is_inclusive_));
+	this->init();
+}
+
+BoundaryScan::BoundaryScan(TString mode, int jet_bin, bool is_inclusive,
+		SampleSet& samples) :
+		sample_set_(&samples), owns_sample_set_(false), mode_(mode), jet_bin_(
+				jet_bin), is_inclusive_(is_inclusive), n_met_cells_(0), n_iso_cells_(
+				0), binning_(0) {
+	this->init();
+}
+
+BoundaryScan::~BoundaryScan() {
+	if (owns_sample_set_)
+		delete sample_set_;
+}
+
+TString BoundaryScan::GetHistoName(const DataSample* sample, TString mode,
+		int jet_bin, bool is_inclusive) {
+	TString suffix = "";
+	if (is_inclusive != 0)
+		suffix = "inc";
+
+	return TString::Format("h_met_etcone20_%s_%ijet%s_%s", mode.Data(),
+			jet_bin, suffix.Data(), sample->GetChannel().Data());
+}
+
+TString BoundaryScan::GetHistoName() const {
+	return GetHistoName(sample_set_->GetDataSample(), mode_, jet_bin_,
+			is_inclusive_);
+}
+
+SampleSet::SampleSetup BoundaryScan::GetSampleSetup(TString mode, int jet_bin,
+		bool is_inclusive) {
+	return [mode, jet_bin, is_inclusive](DataSample* sample) {
+		sample->RequestHisto(
+				GetHistoName(sample, mode, jet_bin, is_inclusive));
+	};
+}
+
+// A no-op for samples set up with GetSampleSetup
+void BoundaryScan::init() {
+	SampleSet::SampleSetup setup = GetSampleSetup(mode_, jet_bin_,
+			is_inclusive_);
+	const SampleCollection& samples = sample_set_->GetSamples();
+	SampleCollection::const_iterator iter = samples.begin();
+	SampleCollection::const_iterator iter_end = samples.end();
+	for (; iter != iter_end; iter++) {
+		setup(iter->second);
+	}
+
+	this->BuildTables();
+}
+
+// Integrates data minus MC, and the variances of all samples, cell by cell
+void BoundaryScan::BuildTables() {
+	binning_ = (TH2*) sample_set_->GetDataSample()->GetHisto(
+			this->GetHistoName());
+
+	n_met_cells_ = binning_->GetNbinsX() + 2;
+	n_iso_cells_ = binning_->GetNbinsY() + 2;
+
+	int row_length = n_iso_cells_ + 1;
+	content_table_.assign((n_met_cells_ + 1) * row_length, 0.);
+	variance_table_.assign((n_met_cells_ + 1) * row_length, 0.);
+
+	std::vector<TH2*> histos;
+	std::vector<double> signs;
+	const SampleCollection& samples = sample_set_->GetSamples();
+	const std::vector<std::string>& sample_names =
+			sample_set_->GetSampleNames();
+	for (unsigned int sample_idx = 0; sample_idx != sample_names.size();
+			sample_idx++) {
+		TString sample_name = sample_names.at(sample_idx);
+		DataSample* sample = samples.find(sample_name)->second;
+		histos.push_back(
+				(TH2*) sample->GetHisto(
+						GetHistoName(sample, mode_, jet_bin_, is_inclusive_)));
+		signs.push_back(SampleSet::IsData(sample_name) ? 1. : -1.);
+	}
+
+	for (int met_cell = 0; met_cell != n_met_cells_; met_cell++) {
+		double row_content = 0.;
+		double row_variance = 0.;
+		for (int iso_cell = 0; iso_cell != n_iso_cells_; iso_cell++) {
+			for (unsigned int histo_idx = 0; histo_idx != histos.size();
+					histo_idx++) {
+				double error = histos[histo_idx]->GetBinError(met_cell,
+						iso_cell);
+				row_content += signs[histo_idx]
+						* histos[histo_idx]->GetBinContent(met_cell, iso_cell);
+				row_variance += error * error;
+			}
+			int cell = (met_cell + 1) * row_length + (iso_cell + 1);
+			content_table_[cell] = content_table_[cell - row_length]
+					+ row_content;
+			variance_table_[cell] = variance_table_[cell - row_length]
+					+ row_variance;
+		}
+	}
+}
+
+// Sum over the inclusive cell ranges, four lookups
+double BoundaryScan::BoxSum(const std::vector<double>& table, int met_low,
+		int met_high, int iso_low, int iso_high) const {
+	int row_length = n_iso_cells_ + 1;
+	return table[(met_high + 1) * row_length + (iso_high + 1)]
+			- table[met_low * row_length + (iso_high + 1)]
+			- table[(met_high + 1) * row_length + iso_low]
+			+ table[met_low * row_length + iso_low];
+}
+
+void BoundaryScan::GetRegionBox(int region, int met_bin, int iso_bin,
+		int& met_low, int& met_high, int& iso_low, int& iso_high) const {
+	bool low_met = (region == AbcdBase::A || region == AbcdBase::B);
+	bool non_isolated = (region == AbcdBase::A || region == AbcdBase::C);
+
+	met_low = low_met ? 0 : met_bin + 1;
+	met_high = low_met ? met_bin : n_met_cells_ - 1;
+	iso_low = non_isolated ? iso_bin + 1 : 0;
+	iso_high = non_isolated ? n_iso_cells_ - 1 : iso_bin;
+}
+
+double BoundaryScan::GetCorrectedRegionYield(int region, int met_bin,
+		int iso_bin) const {
+	int met_low, met_high, iso_low, iso_high;
+	this->GetRegionBox(region, met_bin, iso_bin, met_low, met_high, iso_low,
+			iso_high);
+	return this->BoxSum(content_table_, met_low, met_high, iso_low, iso_high);
+}
+
+double BoundaryScan::GetRegionError(int region, int met_bin,
+		int iso_bin) const {
+	int met_low, met_high, iso_low, iso_high;
+	this->GetRegionBox(region, met_bin, iso_bin, met_low, met_high, iso_low,
+			iso_high);
+	return sqrt(
+			this->BoxSum(variance_table_, met_low, met_high, iso_low,
+					iso_high));
+}
+
+double BoundaryScan::GetNdEstimate(int met_bin, int iso_bin) const {
+	double nA_corr = this->GetCorrectedRegionYield(AbcdBase::A, met_bin,
+			iso_bin);
+	double nB_corr = this->GetCorrectedRegionYield(AbcdBase::B, met_bin,
+			iso_bin);
+	double nC_corr = this->GetCorrectedRegionYield(AbcdBase::C, met_bin,
+			iso_bin);
+
+	return nB_corr * nC_corr / nA_corr;
+}
+
+// Relative errors of A, B and C added in quadrature
+double BoundaryScan::GetNdError(int met_bin, int iso_bin) const {
+	double sum = 0.;
+	int regions[] = { AbcdBase::A, AbcdBase::B, AbcdBase::C };
+	for (int region_idx = 0; region_idx != 3; region_idx++) {
+		double rel_error = this->GetRegionError(regions[region_idx], met_bin,
+				iso_bin)
+				/ this->GetCorrectedRegionYield(regions[region_idx], met_bin,
+						iso_bin);
+		sum += rel_error * rel_error;
+	}
+	return this->GetNdEstimate(met_bin, iso_bin) * sqrt(sum);
+}
+
+void BoundaryScan::Scan(TString output_path, double nominal_met_cut,
+		double nominal_iso_cut) {
+	int n_met_bins = binning_->GetNbinsX();
+	int n_iso_bins = binning_->GetNbinsY();
+
+	// Cuts on the upper edges of bins 1 .. n - 1, the bin holding the
+	// nominal cut is the reference
+	int nominal_met_bin = binning_->GetXaxis()->FindFixBin(nominal_met_cut)
+			- 1;
+	int nominal_iso_bin = binning_->GetYaxis()->FindFixBin(nominal_iso_cut)
+			- 1;
+	double nominal = this->GetNdEstimate(nominal_met_bin, nominal_iso_bin);
+
+	std::vector<double> estimates((n_met_bins + 2) * (n_iso_bins + 2), 0.);
+	std::vector<double> errors(estimates.size(), 0.);
+
+	ParallelFor(n_met_bins - 1, [&](unsigned int row) {
+		int met_bin = row + 1;
+		for (int iso_bin = 1; iso_bin != n_iso_bins; iso_bin++) {
+			int cell = met_bin * (n_iso_bins + 2) + iso_bin;
+			estimates[cell] = this->GetNdEstimate(met_bin, iso_bin);
+			errors[cell] = this->GetNdError(met_bin, iso_bin);
+		}
+	});
+
+	TString label = TString::Format("%s_%i%s", mode_.Data(), jet_bin_,
+			is_inclusive_ ? "inc" : "");
+	TH2D* h_estimate = (TH2D*) binning_->Clone("h_nD_" + label);
+	TH2D* h_error = (TH2D*) binning_->Clone("h_nD_error_" + label);
+	TH2D* h_shift = (TH2D*) binning_->Clone("h_nD_shift_" + label);
+	h_estimate->Reset();
+	h_error->Reset();
+	h_shift->Reset();
+
+	for (int met_bin = 1; met_bin != n_met_bins; met_bin++) {
+		for (int iso_bin = 1; iso_bin != n_iso_bins; iso_bin++) {
+			int cell = met_bin * (n_iso_bins + 2) + iso_bin;
+			h_estimate->SetBinContent(met_bin, iso_bin, estimates[cell]);
+			h_estimate->SetBinError(met_bin, iso_bin, errors[cell]);
+			h_error->SetBinContent(met_bin, iso_bin, errors[cell]);
+			h_shift->SetBinContent(met_bin, iso_bin,
+					(estimates[cell] - nominal) / nominal);
+		}
+	}
+
+	TFile* output = new TFile(output_path, "RECREATE");
+	h_estimate->SetDirectory(output);
+	h_error->SetDirectory(output);
+	h_shift->SetDirectory(output);
+	output->Write();
+	output->Close();
+	delete output;
+
+	std::cout << "BoundaryScan::Scan - " << label << " nominal nD: " << nominal
+			<< ", maps written to " << output_path << std::endl;
+}
@@ -0,0 +1,83 @@
+/*
+ * BoundaryScan.h
+ * Checks the stability of the ABCD estimate against the MET and
+ * etcone20 cuts that separate the regions. Reads the 2D MET vs etcone20
+ * histograms of one jet bin, builds summed-area tables of the corrected
+ * yields and variances and evaluates nD for every pair of cuts on the
+ * bin edges with four table lookups per region.
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef BOUNDARYSCAN_H_
+#define BOUNDARYSCAN_H_
+
+#include <vector>
+#include "TString.h"
+#include "TH2.h"
+#include "DataSample.h"
+#include "SampleSet.h"
+
+class BoundaryScan {
+
+private:
+	// Owns the sample set unless it was passed in
+	SampleSet* sample_set_;
+	bool owns_sample_set_;
+
+	TString mode_;
+	int jet_bin_;
+	bool is_inclusive_;
+
+	// Summed-area tables of data minus MC and of the summed variances,
+	// over all bins including under- and overflow
+	std::vector<double> content_table_;
+	std::vector<double> variance_table_;
+	int n_met_cells_;
+	int n_iso_cells_;
+	TH2* binning_;
+
+	void init(void);
+	void BuildTables(void);
+	double BoxSum(const std::vector<double>& table, int met_low, int met_high,
+			int iso_low, int iso_high) const;
+	void GetRegionBox(int region, int met_bin, int iso_bin, int& met_low,
+			int& met_high, int& iso_low, int& iso_high) const;
+
+	BoundaryScan(const BoundaryScan&);
+	BoundaryScan& operator=(const BoundaryScan&);
+
+public:
+	BoundaryScan(TString mode = "tag", int jet_bin = 3, bool is_inclusive =
+			false);
+	// Reads from the samples of a set, which has to outlive the scan. The
+	// histogram is requested from every sample, so the set is best built
+	// with GetSampleSetup: a sample read without it is read again.
+	BoundaryScan(TString mode, int jet_bin, bool is_inclusive,
+			SampleSet& samples);
+	virtual ~BoundaryScan();
+
+	// h_met_etcone20_<mode>_<n>jet_<channel>, or <n>jetinc for n jets and
+	// more, in the channel of the sample
+	static TString GetHistoName(const DataSample* sample, TString mode,
+			int jet_bin, bool is_inclusive);
+	TString GetHistoName(void) const;
+	// Requests the histogram of a scan before the samples are read
+	static SampleSet::SampleSetup GetSampleSetup(TString mode, int jet_bin,
+			bool is_inclusive);
+
+	// The cuts sit on the upper edges of MET bin met_bin and etcone20 bin
+	// iso_bin. A and B are below the MET cut, A and C are non-isolated.
+	double GetCorrectedRegionYield(int region, int met_bin, int iso_bin) const;
+	double GetRegionError(int region, int met_bin, int iso_bin) const;
+
+	double GetNdEstimate(int met_bin, int iso_bin) const;
+	double GetNdError(int met_bin, int iso_bin) const;
+
+	// Evaluates every cut pair in parallel and writes the maps of nD, its
+	// error and the relative shift from the nominal cuts to output_path
+	void Scan(TString output_path, double nominal_met_cut,
+			double nominal_iso_cut);
+};
+
+#endif /* BOUNDARYSCAN_H_ */
@@ -0,0 +1,17 @@
+#!/bin/bash
+# Writes a columnar store next to every ROOT file given, e.g.
+#   ./ConvertHistoStore.sh ./TopD3PDHistos_*_el.root
+# DataSample::UseHistoStores then reads the .hstore files instead.
+
+if [ $# -eq 0 ]; then
+	echo "Usage: $0 TopD3PDHistos_<sample>_<channel>.root ..."
+	exit 1
+fi
+
+for root_file in "$@"; do
+	store_file="${root_file%.root}.hstore"
+	echo Converting $root_file to $store_file
+	root -l -b -q -e '.L HistoStore.cpp+' \
+		-e "gSystem->Exit(HistoStore::Convert(\"$root_file\", \"$store_file\") ? 0 : 1);" || exit 1
+done
+echo "Done! :-)"
@@ -6,75 +6,884 @@
  */
 
 #include "DataSample.h"
+#include "TROOT.h"
+#include "ParallelFor.h"
+#include "RunTrace.h"
+#include "RegionYieldTable.h"
+#include "RegionCube.h"
+#include "SharedYieldSegment.h"
 #include <iostream>
+#include <glob.h>
+#include <algorithm>
 #include "math.h"
 
+namespace {
+
+const char* kModes[] = { "pretag", "tag" };
+const int kNModes = 2;
+
+} // End anonymous namespace
+
 DataSample::DataSample(TString sample_name_) :
-		sample_name(sample_name_) {
+		is_loaded(false), yield_table(0), norm_scale(1.), data_sample(0), owns_data_sample(
+				false), is_in_memory(false), memory_scale(1.), shared_timeout(
+				0.), shared_segment(0), sample_name(sample_name_) {
+	this->init();
+}
+
+DataSample::DataSample(TString sample_name_,
+		const std::vector<TString>& input_files_) :
+		input_files(input_files_), is_loaded(false), yield_table(0), norm_scale(
+				1.), data_sample(0), owns_data_sample(false), is_in_memory(
+				false), memory_scale(1.), shared_timeout(0.), shared_segment(
+				0), sample_name(sample_name_) {
 	this->init();
 }
 
 DataSample::~DataSample() {
-	file->Close();
-	delete file;
+	if (owns_data_sample)
+		delete data_sample;
+	ClearDatabase(histo_database);
+	for (unsigned int file_idx = 0; file_idx != file_histo_databases.size();
+			file_idx++) {
+		ClearDatabase(file_histo_databases.at(file_idx));
+	}
+	this->ClearStores();
+	this->ClearRegionCubes();
+	delete yield_table;
+	// The yield store views the segment, it goes last
+	yield_store.Clear();
+	delete shared_segment;
 	sample_name = "";
 	sample_path = "";
 	sample_full_name = "";
 }
 
 void DataSample::init() {
-	this->SetSamplePath(Form("./TopD3PDHistos_%s_el.root", sample_name.Data()));
-	file = new TFile(sample_path);
+	TString default_labels[] = { "A", "B", "C", "D" };
+	region_labels.assign(default_labels, default_labels + 4);
+
+	if (channel.Length() == 0)
+		channel = "el";
+
+	this->SetSamplePath(
+			TString::Format("./TopD3PDHistos_%s_%s.root", sample_name.Data(),
+					channel.Data()));
+	// Default to the single merged file when no inputs were given
+	if (input_files.empty()) {
+		input_files.push_back(sample_path);
+	}
 }
 
-std::vector<TH1D*> DataSample::GetHistos(TString mode) {
-	std::vector<TH1D*> histos;
+void DataSample::SetChannel(TString channel_) {
+	std::lock_guard<std::mutex> lock(load_mutex);
+	bool is_default = (input_files.size() == 1
+			&& input_files.at(0) == sample_path);
+
+	channel = channel_;
+	this->SetSamplePath(
+			TString::Format("./TopD3PDHistos_%s_%s.root", sample_name.Data(),
+					channel.Data()));
+	if (is_default)
+		input_files.at(0) = sample_path;
+	is_loaded = false;
+}
 
-	TString suffix = "h_njet";
-	TString regions[] = { "A", "B", "C", "D" };
+void DataSample::SetNormalisation(double cross_section, double k_factor,
+		double sum_of_weights, double luminosity) {
+	if (sum_of_weights == 0.) {
+		std::cout << "DataSample::SetNormalisation - Sum of weights of "
+				<< sample_name << " is zero" << std::endl;
+		exit(-1);
+	}
+	std::lock_guard<std::mutex> lock(load_mutex);
+	norm_scale = luminosity * cross_section * k_factor / sum_of_weights;
+	is_loaded = false;
+}
+
+void DataSample::SetDataSample(DataSample* data_sample_) {
+	if (owns_data_sample)
+		delete data_sample;
+	data_sample = data_sample_;
+	owns_data_sample = false;
+}
+
+void DataSample::SetRegionLabels(const std::vector<TString>& region_labels_) {
+	std::lock_guard<std::mutex> lock(load_mutex);
+	region_labels = region_labels_;
+	is_loaded = false;
+}
+
+void DataSample::AddInputFile(TString file_path) {
+	std::lock_guard<std::mutex> lock(load_mutex);
+	// The default single file is replaced by the first explicit input
+	if (input_files.size() == 1 && input_files.at(0) == sample_path) {
+		input_files.clear();
+	}
+	input_files.push_back(file_path);
+	is_in_memory = false;
+	memory_store.Clear();
+	is_loaded = false;
+}
+
+// Adds every file matching a shell pattern, e.g. "./TopD3PDHistos_data*_el.root"
+void DataSample::AddInputFiles(TString pattern) {
+	glob_t matches;
+	int status = glob(pattern.Data(), 0, 0, &matches);
+
+	if (status != 0 || matches.gl_pathc == 0) {
+		std::cout << "DataSample::AddInputFiles - No files match " << pattern
+				<< std::endl;
+		globfree(&matches);
+		exit(-1);
+	}
+
+	// glob returns the matches sorted so file indices are reproducible
+	for (size_t match_idx = 0; match_idx != matches.gl_pathc; match_idx++) {
+		this->AddInputFile(matches.gl_pathv[match_idx]);
+	}
+	globfree(&matches);
+}
+
+unsigned int DataSample::GetNFiles() const {
+	return input_files.size();
+}
+
+TString DataSample::GetInputFile(unsigned int file_index) const {
+	return input_files.at(file_index);
+}
+
+void DataSample::UseHistoStores() {
+	std::lock_guard<std::mutex> lock(load_mutex);
+	for (unsigned int file_idx = 0; file_idx != input_files.size();
+			file_idx++) {
+		if (!HistoStore::IsStorePath(input_files.at(file_idx)))
+			input_files.at(file_idx) = HistoStore::GetStorePathFor(
+					input_files.at(file_idx));
+	}
+	is_loaded = false;
+}
+
+void DataSample::UseSharedMemory(double timeout) {
+	std::lock_guard<std::mutex> lock(load_mutex);
+	shared_timeout = timeout;
+	is_loaded = false;
+}
+
+// Everything the merged bins depend on besides the files themselves
+uint64_t DataSample::GetSharedKey() const {
+	std::vector<TString> settings;
+	settings.push_back(sample_name);
+	settings.push_back(channel);
+	settings.push_back(TString::Format("%.17g", norm_scale));
+	std::vector<TString> histo_names = this->GetRegionHistoNames();
+	settings.insert(settings.end(), histo_names.begin(), histo_names.end());
+	return SharedYieldSegment::MakeKey(settings, input_files);
+}
+
+bool DataSample::UsesHistoStores() const {
+	return !input_files.empty() && HistoStore::IsStorePath(input_files.at(0));
+}
+
+TString DataSample::GetHistoName(TString mode, TString region_label) const {
+	return TString::Format("h_njet_%s_%s_%s", mode.Data(), region_label.Data(),
+			channel.Data());
+}
+
+std::vector<TString> DataSample::GetModes() {
+	return std::vector<TString>(kModes, kModes + kNModes);
+}
+
+TString DataSample::GetRegionHistoName(TString mode, int region) const {
+	return GetHistoName(mode, region_labels.at(region));
+}
+
+// Every mode and region, in the order they are put in the yield stores
+std::vector<TString> DataSample::GetRegionHistoNames() const {
+	std::vector<TString> histo_names;
+	for (int mode_idx = 0; mode_idx != kNModes; mode_idx++) {
+		for (unsigned int region_idx = 0; region_idx != region_labels.size();
+				region_idx++) {
+			histo_names.push_back(
+					GetHistoName(kModes[mode_idx], region_labels.at(region_idx)));
+		}
+	}
+	return histo_names;
+}
+
+// Reads the region histograms of one input file into its own database
+void DataSample::ReadFile(unsigned int file_index) const {
+	TString file_path = input_files.at(file_index);
+	TFile* file = 0;
+	{
+		TraceSpan span("io", "OpenFile", file_path.Data());
+		file = TFile::Open(file_path);
+	}
+
+	if (file == 0 || file->IsZombie()) {
+		std::cout << "DataSample::ReadFile - Sample file NOT found: "
+				<< file_path << std::endl;
+		exit(-1);
+	}
 
-	for (int region_idx = 0; region_idx != 4; region_idx++) {
-		TString region_label = regions[region_idx];
+	HistoDatabase& database = file_histo_databases.at(file_index);
+
+	std::vector<TString> histo_names = requested_histos;
+	std::vector<TString> region_histo_names = this->GetRegionHistoNames();
+	histo_names.insert(histo_names.end(), region_histo_names.begin(),
+			region_histo_names.end());
+	TraceSpan span("read", "ReadHistos", file_path.Data());
+	for (unsigned int histo_idx = 0; histo_idx != histo_names.size();
+			histo_idx++) {
+		TString histo_name = histo_names.at(histo_idx);
+		TH1* histo = (TH1*) file->Get(histo_name);
+		if (histo == 0) {
+			std::cout << "DataSample::ReadFile - " << histo_name
+					<< " NOT found in " << file_path << std::endl;
+			exit(-1);
+		}
+		// Detach from the file so it can be closed
+		histo->SetDirectory(0);
+		database[histo_name] = histo;
+	}
+
+	file->Close();
+	delete file;
+}
+
+// Sums the per-file histograms pairwise, halving the number of partial
+// sums at every level, so independent pairs can be merged concurrently
+void DataSample::MergeFiles() const {
+	TraceSpan span("merge", "MergeFiles", sample_name.Data());
+	unsigned int n_files = file_histo_databases.size();
+	std::vector<HistoDatabase> partial_sums(n_files);
+
+	for (unsigned int file_idx = 0; file_idx != n_files; file_idx++) {
+		HistoDatabase::iterator iter = file_histo_databases.at(file_idx).begin();
+		HistoDatabase::iterator iter_end = file_histo_databases.at(file_idx).end();
+		for (; iter != iter_end; iter++) {
+			TH1* histo = (TH1*) iter->second->Clone();
+			histo->SetDirectory(0);
+			partial_sums.at(file_idx)[iter->first] = histo;
+		}
+	}
+
+	for (unsigned int stride = 1; stride < n_files; stride *= 2) {
+		unsigned int n_pairs = (n_files + 2 * stride - 1) / (2 * stride);
+		ParallelFor(n_pairs, [&](unsigned int pair_idx) {
+			unsigned int target = pair_idx * 2 * stride;
+			unsigned int source = target + stride;
+			if (source >= n_files)
+				return;
+
+			HistoDatabase::iterator iter = partial_sums.at(target).begin();
+			HistoDatabase::iterator iter_end = partial_sums.at(target).end();
+			for (; iter != iter_end; iter++) {
+				iter->second->Add(partial_sums.at(source)[iter->first]);
+			}
+			ClearDatabase(partial_sums.at(source));
+		});
+	}
+
+	histo_database = partial_sums.at(0);
+}
+
+// Copies a histogram into the store, the errors give sumw2 also for
+// histograms filled without Sumw2
+void DataSample::AddHistoToStore(YieldStore& store, TString histo_name,
+		TH1* histo, double scale) {
+	unsigned int n_bins = histo->GetNbinsX() + 2;
+	std::vector<double> contents(n_bins);
+	std::vector<double> sumw2(n_bins);
+	std::vector<double> edges(n_bins - 1);
+
+	for (unsigned int bin = 0; bin != n_bins; bin++) {
+		double error = histo->GetBinError(bin);
+		contents[bin] = histo->GetBinContent(bin);
+		sumw2[bin] = error * error;
+	}
+	for (unsigned int bin = 1; bin != n_bins; bin++) {
+		edges[bin - 1] = histo->GetXaxis()->GetBinLowEdge(bin);
+	}
+	store.Add(histo_name, &contents[0], &sumw2[0], &edges[0], n_bins, scale);
+}
+
+// Moves the merged and per-file region histograms into the yield stores,
+// normalised. Requested histograms stay in the databases, scaled there.
+void DataSample::FillYieldStores() const {
+	unsigned int n_files = file_histo_databases.size();
+	file_yield_stores.assign(n_files, YieldStore());
+
+	ParallelFor(n_files + 1, [&](unsigned int store_idx) {
+		bool is_merged = (store_idx == n_files);
+		HistoDatabase& database =
+				is_merged ? histo_database : file_histo_databases.at(store_idx);
+		YieldStore& store =
+				is_merged ? yield_store : file_yield_stores.at(store_idx);
+		this->MoveToYieldStore(database, store);
+	});
+}
+
+// Moves the region histograms of a database into the store and scales
+// the histograms left over
+void DataSample::MoveToYieldStore(HistoDatabase& database,
+		YieldStore& store) const {
+	std::vector<TString> histo_names = this->GetRegionHistoNames();
+	store.Reserve(
+			histo_names.size() * (database[histo_names.at(0)]->GetNbinsX() + 2));
+	for (unsigned int histo_idx = 0; histo_idx != histo_names.size();
+			histo_idx++) {
+		HistoDatabase::iterator found = database.find(histo_names.at(histo_idx));
+		AddHistoToStore(store, found->first, found->second, norm_scale);
+		delete found->second;
+		database.erase(found);
+	}
+
+	// TH1::Scale also scales sumw2 by the square
+	if (norm_scale != 1.) {
+		HistoDatabase::iterator iter = database.begin();
+		for (; iter != database.end(); iter++) {
+			iter->second->Scale(norm_scale);
+		}
+	}
+}
+
+// Maps one store and checks it holds every region histogram
+void DataSample::ReadStore(unsigned int file_index) const {
+	TString file_path = input_files.at(file_index);
+	TraceSpan span("io", "MapStore", file_path.Data());
+	HistoStore* store = new HistoStore(file_path);
+
+	if (!store->IsOpen()) {
+		std::cout << "DataSample::ReadStore - Sample store NOT readable: "
+				<< file_path << std::endl;
+		exit(-1);
+	}
+
+	std::vector<TString> histo_names = this->GetRegionHistoNames();
+	for (unsigned int histo_idx = 0; histo_idx != histo_names.size();
+			histo_idx++) {
+		if (store->Find(histo_names.at(histo_idx)) < 0) {
+			std::cout << "DataSample::ReadStore - " << histo_names.at(histo_idx)
+					<< " NOT found in " << file_path << std::endl;
+			exit(-1);
+		}
+	}
+	file_stores.at(file_index) = store;
+}
+
+// Same pairwise order as MergeFiles, so both backends sum identically.
+// Only the region bins are copied out of the mapped stores, the sums are
+// done in double and rounded once when they go into the yield store.
+void DataSample::MergeStores() const {
+	TraceSpan span("merge", "MergeStores", sample_name.Data());
+	std::vector<TString> histo_names = this->GetRegionHistoNames();
+	unsigned int n_files = file_stores.size();
+	std::vector<BinDatabase> partial_sums(n_files);
+	file_yield_stores.assign(n_files, YieldStore());
+
+	ParallelFor(n_files, [&](unsigned int file_idx) {
+		HistoStore* store = file_stores.at(file_idx);
+		for (unsigned int histo_idx = 0; histo_idx != histo_names.size();
+				histo_idx++) {
+			TString histo_name = histo_names.at(histo_idx);
+			int store_idx = store->Find(histo_name);
+			HistoBins bins = store->GetBins(store_idx);
+
+			SummedBins& summed = partial_sums.at(file_idx)[histo_name];
+			summed.contents.assign(bins.contents, bins.contents + bins.n_bins);
+			summed.sumw2.assign(bins.sumw2, bins.sumw2 + bins.n_bins);
+		}
+		this->CopyStoreBins(file_idx);
+	});
+
+	for (unsigned int stride = 1; stride < n_files; stride *= 2) {
+		unsigned int n_pairs = (n_files + 2 * stride - 1) / (2 * stride);
+		ParallelFor(n_pairs, [&](unsigned int pair_idx) {
+			unsigned int target = pair_idx * 2 * stride;
+			unsigned int source = target + stride;
+			if (source >= n_files)
+				return;
+
+			BinDatabase::iterator iter = partial_sums.at(target).begin();
+			BinDatabase::iterator iter_end = partial_sums.at(target).end();
+			for (; iter != iter_end; iter++) {
+				SummedBins& added = partial_sums.at(source).at(iter->first);
+				for (unsigned int bin = 0; bin != iter->second.contents.size();
+						bin++) {
+					iter->second.contents[bin] += added.contents.at(bin);
+					iter->second.sumw2[bin] += added.sumw2.at(bin);
+				}
+			}
+			partial_sums.at(source).clear();
+		});
+	}
+
+	HistoStore* binning = file_stores.at(0);
+	for (unsigned int histo_idx = 0; histo_idx != histo_names.size();
+			histo_idx++) {
+		TString histo_name = histo_names.at(histo_idx);
+		SummedBins& summed = partial_sums.at(0).at(histo_name);
+		yield_store.Add(histo_name, &summed.contents[0], &summed.sumw2[0],
+				binning->GetEdges(binning->Find(histo_name)),
+				summed.contents.size(), norm_scale);
+	}
+}
+
+// Region bins of one mapped store into its file yield store
+void DataSample::CopyStoreBins(unsigned int file_index) const {
+	std::vector<TString> histo_names = this->GetRegionHistoNames();
+	HistoStore* store = file_stores.at(file_index);
+	YieldStore& yields = file_yield_stores.at(file_index);
+	for (unsigned int histo_idx = 0; histo_idx != histo_names.size();
+			histo_idx++) {
+		int store_idx = store->Find(histo_names.at(histo_idx));
+		HistoBins bins = store->GetBins(store_idx);
+		yields.Add(histo_names.at(histo_idx), bins.contents, bins.sumw2,
+				store->GetEdges(store_idx), bins.n_bins, norm_scale);
+	}
+}
+
+void DataSample::ClearStores() const {
+	for (unsigned int file_idx = 0; file_idx != file_stores.size();
+			file_idx++) {
+		delete file_stores.at(file_idx);
+	}
+	file_stores.clear();
+}
+
+void DataSample::ClearRegionCubes() const {
+	std::map<TString, RegionCube*>::iterator iter = region_cubes.begin();
+	std::map<TString, RegionCube*>::iterator iter_end = region_cubes.end();
+	for (; iter != iter_end; iter++) {
+		delete iter->second;
+	}
+	region_cubes.clear();
+}
+
+void DataSample::Load() const {
+	if (is_loaded)
+		return;
+
+	// A prefetch thread may be loading this sample already, wait for it
+	std::lock_guard<std::mutex> lock(load_mutex);
+	if (is_loaded)
+		return;
+
+	// Bins set in memory have no files to read the other histograms from
+	if (is_in_memory) {
+		if (!requested_histos.empty()) {
+			std::cout << "DataSample::Load - " << requested_histos.at(0)
+					<< " cannot be read, " << sample_name
+					<< " was filled in memory" << std::endl;
+			exit(-1);
+		}
+		if (norm_scale != memory_scale)
+			this->RescaleMemoryStore();
+		is_loaded = true;
+		return;
+	}
+
+	// A second span for the same sample is a reload
+	TraceSpan span("load", "Load", sample_name.Data());
+	ClearDatabase(histo_database);
+	for (unsigned int file_idx = 0; file_idx != file_histo_databases.size();
+			file_idx++) {
+		ClearDatabase(file_histo_databases.at(file_idx));
+	}
+	yield_store.Clear();
+	file_yield_stores.clear();
+	this->ClearRegionCubes();
+	delete yield_table;
+	yield_table = 0;
+	delete shared_segment;
+	shared_segment = 0;
+
+	// Either view the bins another job published, or claim the segment
+	// and publish ours once read
+	SharedYieldSegment* claimed_segment = 0;
+	uint64_t shared_key =
+			(shared_timeout > 0. && requested_histos.empty()) ?
+					this->GetSharedKey() : 0;
+	if (shared_key != 0) {
+		SharedYieldSegment* segment = new SharedYieldSegment(shared_key);
+		if (segment->Create()) {
+			claimed_segment = segment;
+		} else {
+			bool is_attached = false;
+			{
+				TraceSpan attach_span("io", "AttachSegment",
+						segment->GetName().Data());
+				is_attached = segment->Attach(shared_timeout);
+			}
+			if (is_attached) {
+				segment->View(yield_store);
+				shared_segment = segment;
+				is_loaded = true;
+				return;
+			}
+			// Its owner never finished, take the segment over or at least
+			// read the files ourselves
+			if (segment->Reclaim())
+				claimed_segment = segment;
+			else
+				delete segment;
+		}
+	}
+
+	unsigned int n_stores = 0;
+	for (unsigned int file_idx = 0; file_idx != input_files.size();
+			file_idx++) {
+		if (HistoStore::IsStorePath(input_files.at(file_idx)))
+			n_stores++;
+	}
+	if (n_stores != 0 && n_stores != input_files.size()) {
+		std::cout << "DataSample::Load - " << sample_name
+				<< " mixes ROOT files and stores" << std::endl;
+		exit(-1);
+	}
+
+	file_histo_databases.assign(input_files.size(), HistoDatabase());
+
+	// Stores only hold the 1D histograms, no ROOT I/O needed. They are
+	// unmapped again once their region bins are copied.
+	if (n_stores != 0) {
+		if (!requested_histos.empty()) {
+			std::cout << "DataSample::Load - " << requested_histos.at(0)
+					<< " needs the ROOT files, not stores" << std::endl;
+			exit(-1);
+		}
+		file_stores.assign(input_files.size(), (HistoStore*) 0);
+		ParallelFor(input_files.size(), [this](unsigned int file_idx) {
+			this->ReadStore(file_idx);
+		});
+		this->MergeStores();
+		this->ClearStores();
+	} else {
+		ROOT::EnableThreadSafety();
+
+		ParallelFor(input_files.size(), [this](unsigned int file_idx) {
+			this->ReadFile(file_idx);
+		});
+		this->MergeFiles();
+		this->FillYieldStores();
+	}
+
+	if (claimed_segment != 0) {
+		TraceSpan publish_span("io", "PublishSegment",
+				claimed_segment->GetName().Data());
+		claimed_segment->Publish(yield_store);
+		delete claimed_segment;
+	}
+
+	is_loaded = true;
+}
+
+// A job attached to a shared segment only views the merged bins, the
+// per-file ones are read from the inputs on first use
+void DataSample::LoadFileStores() const {
+	this->Load();
+	std::lock_guard<std::mutex> lock(load_mutex);
+	if (shared_segment == 0
+			|| file_yield_stores.size() == input_files.size())
+		return;
+
+	TraceSpan span("load", "LoadFileStores", sample_name.Data());
+	unsigned int n_files = input_files.size();
+	file_histo_databases.assign(n_files, HistoDatabase());
+	file_yield_stores.assign(n_files, YieldStore());
+
+	// The job that published the segment checked the inputs are all
+	// stores or all ROOT files
+	if (HistoStore::IsStorePath(input_files.at(0))) {
+		file_stores.assign(n_files, (HistoStore*) 0);
+		ParallelFor(n_files, [this](unsigned int file_idx) {
+			this->ReadStore(file_idx);
+			this->CopyStoreBins(file_idx);
+		});
+		this->ClearStores();
+	} else {
+		ROOT::EnableThreadSafety();
+		ParallelFor(n_files, [this](unsigned int file_idx) {
+			this->ReadFile(file_idx);
+			this->MoveToYieldStore(file_histo_databases.at(file_idx),
+					file_yield_stores.at(file_idx));
+		});
+	}
+}
+
+size_t DataSample::GetYieldStoreBytes() const {
+	size_t n_bytes = yield_store.GetNBytes() + memory_store.GetNBytes();
+	for (unsigned int file_idx = 0; file_idx != file_yield_stores.size();
+			file_idx++) {
+		n_bytes += file_yield_stores.at(file_idx).GetNBytes();
+	}
+	return n_bytes;
+}
+
+void DataSample::SetRegionHistos(const std::map<TString, TH1*>& histos) {
+	std::lock_guard<std::mutex> lock(load_mutex);
+	std::vector<TString> histo_names = this->GetRegionHistoNames();
+	for (unsigned int histo_idx = 0; histo_idx != histo_names.size();
+			histo_idx++) {
+		if (histos.find(histo_names.at(histo_idx)) == histos.end()) {
+			std::cout << "DataSample::SetRegionHistos - "
+					<< histo_names.at(histo_idx) << " missing for "
+					<< sample_name << std::endl;
+			exit(-1);
+		}
+	}
+
+	ClearDatabase(histo_database);
+	for (unsigned int file_idx = 0; file_idx != file_histo_databases.size();
+			file_idx++) {
+		ClearDatabase(file_histo_databases.at(file_idx));
+	}
+	file_histo_databases.clear();
+	file_yield_stores.clear();
+	input_files.clear();
+	this->ClearRegionCubes();
+	delete yield_table;
+	yield_table = 0;
+
+	yield_store.Clear();
+	delete shared_segment;
+	shared_segment = 0;
+	memory_store.Clear();
+	unsigned int n_bins = histos.begin()->second->GetNbinsX() + 2;
+	yield_store.Reserve(histo_names.size() * n_bins);
+	memory_store.Reserve(histo_names.size() * n_bins);
+	for (unsigned int histo_idx = 0; histo_idx != histo_names.size();
+			histo_idx++) {
+		TH1* histo = histos.find(histo_names.at(histo_idx))->second;
+		AddHistoToStore(yield_store, histo_names.at(histo_idx), histo,
+				norm_scale);
+		AddHistoToStore(memory_store, histo_names.at(histo_idx), histo, 1.);
+	}
+	memory_scale = norm_scale;
+
+	is_in_memory = true;
+	is_loaded = true;
+}
+
+// The normalisation changed since the bins were set in memory, the
+// yield store and everything built on it are redone at the new scale
+void DataSample::RescaleMemoryStore() const {
+	this->ClearRegionCubes();
+	delete yield_table;
+	yield_table = 0;
+	yield_store.Clear();
+	yield_store.Reserve(memory_store.GetArenaSize() / 3);
+	for (unsigned int entry = 0; entry != memory_store.GetNEntries();
+			entry++) {
+		unsigned int n_bins = memory_store.GetNBins(entry);
+		std::vector<double> contents(n_bins);
+		std::vector<double> sumw2(n_bins);
+		std::vector<double> edges(n_bins - 1);
+		for (unsigned int bin = 0; bin != n_bins; bin++) {
+			contents[bin] = memory_store.GetBinContent(entry, bin);
+			sumw2[bin] = memory_store.GetBinSumw2(entry, bin);
+		}
+		for (unsigned int bin = 0; bin + 1 < n_bins; bin++) {
+			edges[bin] = memory_store.GetEdge(entry, bin);
+		}
+		yield_store.Add(memory_store.GetName(entry), &contents[0], &sumw2[0],
+				&edges[0], n_bins, norm_scale);
+	}
+	memory_scale = norm_scale;
+}
+
+const YieldStore& DataSample::GetYieldStore() const {
+	this->Load();
+	return yield_store;
+}
+
+const RegionYieldTable* DataSample::GetYieldTable() const {
+	this->Load();
+	std::lock_guard<std::mutex> lock(load_mutex);
+	if (yield_table == 0)
+		yield_table = new RegionYieldTable(this);
+	return yield_table;
+}
+
+// Builds a TH1D from the float bins once and keeps it in the database
+TH1D* DataSample::GetRegionHisto(HistoDatabase& database,
+		const YieldStore& store, TString histo_name) const {
+	std::lock_guard<std::mutex> lock(load_mutex);
+	HistoDatabase::iterator found = database.find(histo_name);
+	if (found != database.end())
+		return (TH1D*) found->second;
+
+	int entry = store.Find(histo_name);
+	unsigned int n_bins = store.GetNBins(entry);
+	std::vector<double> edges(n_bins - 1);
+	for (unsigned int bin = 0; bin + 1 < n_bins; bin++) {
+		edges[bin] = store.GetEdge(entry, bin);
+	}
+
+	TH1D* histo = new TH1D(histo_name, histo_name, n_bins - 2, &edges[0]);
+	histo->SetDirectory(0);
+	histo->Sumw2();
+	for (unsigned int bin = 0; bin != n_bins; bin++) {
+		histo->SetBinContent(bin, store.GetBinContent(entry, bin));
+		histo->SetBinError(bin, sqrt(store.GetBinSumw2(entry, bin)));
+	}
+	database[histo_name] = histo;
+	return histo;
+}
+
+std::vector<TH1D*> DataSample::GetHistosFromStore(HistoDatabase& database,
+		const YieldStore& store, TString mode) const {
+	std::vector<TH1D*> histos;
+
+	for (unsigned int region_idx = 0; region_idx != region_labels.size();
+			region_idx++) {
 		histos.push_back(
-				(TH1D*) file->Get(
-						Form("%s_%s_%s_el", suffix.Data(), mode.Data(),
-								region_label.Data())));
+				this->GetRegionHisto(database, store,
+						GetHistoName(mode, region_labels.at(region_idx))));
 	}
 	return histos;
 }
 
-const double DataSample::GetYield(TString mode, int region, int jet_bin,
-		bool is_inclusive) {
+std::vector<TH1D*> DataSample::GetHistos(TString mode) const {
+	this->Load();
+	return this->GetHistosFromStore(histo_database, yield_store, mode);
+}
+
+std::vector<TH1D*> DataSample::GetFileHistos(unsigned int file_index,
+		TString mode) const {
+	this->LoadFileStores();
+	return this->GetHistosFromStore(file_histo_databases.at(file_index),
+			file_yield_stores.at(file_index), mode);
+}
+
+void DataSample::RequestHisto(TString histo_name) {
+	std::lock_guard<std::mutex> lock(load_mutex);
+	if (std::find(requested_histos.begin(), requested_histos.end(), histo_name)
+			!= requested_histos.end())
+		return;
+	requested_histos.push_back(histo_name);
+	is_loaded = false;
+}
+
+// Returns 0 if the histogram was never requested
+TH1* DataSample::GetHisto(TString histo_name) const {
+	this->Load();
+	// GetRegionHisto may be adding to the database meanwhile
+	std::lock_guard<std::mutex> lock(load_mutex);
+	HistoDatabase::iterator found = histo_database.find(histo_name);
+	return (found != histo_database.end()) ? found->second : 0;
+}
+
+void DataSample::UseRegionCubes() {
+	for (int mode_idx = 0; mode_idx != kNModes; mode_idx++) {
+		this->RequestHisto(this->GetRegionCubeName(kModes[mode_idx]));
+	}
+}
+
+TString DataSample::GetRegionCubeName(TString mode) const {
+	return TString::Format("h_njet_met_etcone20_%s_%s", mode.Data(),
+			channel.Data());
+}
+
+const RegionCube* DataSample::GetRegionCube(TString mode) const {
+	TH1* histo = this->GetHisto(this->GetRegionCubeName(mode));
+	if (histo == 0)
+		return 0;
+
+	std::lock_guard<std::mutex> lock(load_mutex);
+	std::map<TString, RegionCube*>::iterator found = region_cubes.find(mode);
+	if (found != region_cubes.end())
+		return found->second;
+
+	if (histo->GetDimension() != 3) {
+		std::cout << "DataSample::GetRegionCube - " << histo->GetName()
+				<< " of " << sample_name << " is not a 3D histogram"
+				<< std::endl;
+		exit(-1);
+	}
+	RegionCube* cube = new RegionCube((TH3*) histo);
+	region_cubes[mode] = cube;
+	return cube;
+}
+
+TH1* DataSample::GetFileHisto(unsigned int file_index, TString histo_name) const {
+	this->LoadFileStores();
+	std::lock_guard<std::mutex> lock(load_mutex);
+	HistoDatabase& database = file_histo_databases.at(file_index);
+	HistoDatabase::iterator found = database.find(histo_name);
+	return (found != database.end()) ? found->second : 0;
+}
 
+// Bin jet_bin + 1, or bins jet_bin + 1 to 19 (at most the overflow bin)
+// for n jets and more
+double DataSample::GetYieldFromStore(const YieldStore& store,
+		TString histo_name, int jet_bin, bool is_inclusive) {
+	int entry = store.Find(histo_name);
 	int histo_bin = (jet_bin + 1);
-	double bin_content;
 
-	if (is_inclusive != 0) {
-		bin_content = this->GetHistos(mode).at(region)->Integral(histo_bin, 19);
-	} else {
-		bin_content = this->GetHistos(mode).at(region)->GetBinContent(
-				histo_bin);
-	} // End if is Inclusive
-	return bin_content;
-} // End GetYield
+	if (is_inclusive == 0)
+		return store.GetBinContent(entry, histo_bin);
 
-const double DataSample::GetYieldError(TString mode, int region, int jet_bin,
-		bool is_inclusive) {
+	int last_bin = std::min(19, int(store.GetNBins(entry)) - 1);
+	return store.Integral(entry, histo_bin, last_bin);
+}
+
+double DataSample::GetYieldErrorFromStore(const YieldStore& store,
+		TString histo_name, int jet_bin, bool is_inclusive) {
+	int entry = store.Find(histo_name);
 	int histo_bin = (jet_bin + 1);
-	double bin_error = 0;
-	double bin_content = 0;
 
-	if (is_inclusive != 0) {
-		bin_content = this->GetHistos(mode).at(region)->IntegralAndError(
-				histo_bin, 19, bin_error);
-	} else {
-		bin_error = this->GetHistos(mode).at(region)->GetBinError(histo_bin);
-	} // End if Is Inclusive
+	if (is_inclusive == 0)
+		return sqrt(store.GetBinSumw2(entry, histo_bin));
+
+	int last_bin = std::min(19, int(store.GetNBins(entry)) - 1);
+	return sqrt(store.IntegralSumw2(entry, histo_bin, last_bin));
+}
+
+void DataSample::ClearDatabase(HistoDatabase& database) {
+	HistoDatabase::iterator iter = database.begin();
+	HistoDatabase::iterator iter_end = database.end();
+
+	for (; iter != iter_end; iter++) {
+		delete iter->second;
+	}
+	database.clear();
+}
+
+const double DataSample::GetYield(TString mode, int region, int jet_bin,
+		bool is_inclusive) const {
+	this->Load();
+	return GetYieldFromStore(yield_store,
+			GetHistoName(mode, region_labels.at(region)), jet_bin,
+			is_inclusive);
+} // End GetYield
 
-	return bin_error;
+const double DataSample::GetYieldError(TString mode, int region, int jet_bin,
+		bool is_inclusive) const {
+	this->Load();
+	return GetYieldErrorFromStore(yield_store,
+			GetHistoName(mode, region_labels.at(region)), jet_bin,
+			is_inclusive);
 } // End GetYieldError
 
-void DataSample::GetYields() {
+const double DataSample::GetFileYield(unsigned int file_index, TString mode,
+		int region, int jet_bin, bool is_inclusive) const {
+	this->LoadFileStores();
+	return GetYieldFromStore(file_yield_stores.at(file_index),
+			GetHistoName(mode, region_labels.at(region)), jet_bin,
+			is_inclusive);
+} // End GetFileYield
+
+const double DataSample::GetFileYieldError(unsigned int file_index,
+		TString mode, int region, int jet_bin, bool is_inclusive) const {
+	this->LoadFileStores();
+	return GetYieldErrorFromStore(file_yield_stores.at(file_index),
+			GetHistoName(mode, region_labels.at(region)), jet_bin,
+			is_inclusive);
+} // End GetFileYieldError
+
+void DataSample::GetYields() const {
 
 	// Loop over modes
 	TString modes[] = { "pretag", "tag" };
@@ -107,14 +916,14 @@ void DataSample::GetYields() {
 				inc = false;
 			} // End if jet_bin
 
-			TString label = Form("%s(%s)", inc_label.Data(), mode.Data());
+			TString label = TString::Format("%s(%s)", inc_label.Data(), mode.Data());
 			// Jet bin label
 			std::cout << "| " << jet_bin_actual << " " << label << " | ";
 
 			// Regions selector
 			for (int region = 0; region != 4; region++) {
 				std::cout
-						<< Form("%4.2f",
+						<< TString::Format("%4.2f",
 								this->GetYield(mode, region, jet_bin_actual,
 										inc)) << " | ";
 			}
@@ -125,7 +934,7 @@ void DataSample::GetYields() {
 }
 
 const double DataSample::GetContamination(TString mode, int region, int jet_bin,
-		bool is_inclusive) {
+		bool is_inclusive) const {
 
 	return 100 * this->GetYield(mode, region, jet_bin, is_inclusive)
 			/ this->GetDataYield(mode, region, jet_bin, is_inclusive);
@@ -133,7 +942,7 @@ const double DataSample::GetContamination(TString mode, int region, int jet_bin,
 }
 
 const double DataSample::GetContaminationError(TString mode, int region,
-		int jet_bin, bool is_inclusive) {
+		int jet_bin, bool is_inclusive) const {
 
 	double yield = this->GetYield(mode, region, jet_bin, is_inclusive);
 	double data = this->GetDataYield(mode, region, jet_bin, is_inclusive);
@@ -149,7 +958,7 @@ const double DataSample::GetContaminationError(TString mode, int region,
 	return cont * sqrt((yield_sigma*yield_sigma)  + (data_sigma*data_sigma));
 } // End GetContaminationError
 
-void DataSample::GetContaminations() {
+void DataSample::GetContaminations() const {
 
 	// Loop over modes
 	TString modes[] = { "pretag", "tag" };
@@ -183,14 +992,14 @@ void DataSample::GetContaminations() {
 				inc = false;
 			} // End if jet_bin
 
-			TString label = Form("%s(%s)", inc_label.Data(), mode.Data());
+			TString label = TString::Format("%s(%s)", inc_label.Data(), mode.Data());
 			// Jet bin label
 			std::cout << "| " << jet_bin_actual << " " << label << " | ";
 
 			// Regions selector
 			for (int region = 0; region != 4; region++) {
 				std::cout
-						<< Form("%4.2f+-%4.2f",
+						<< TString::Format("%4.2f+-%4.2f",
 								this->GetContamination(mode, region,
 										jet_bin_actual, inc),
 								this->GetContaminationError(mode, region,
@@ -202,14 +1011,29 @@ void DataSample::GetContaminations() {
 	return;
 }
 
+// Returns the data sample, reading it only once per sample
+const DataSample* DataSample::GetDataSample() const {
+	if (sample_name == "dataAllEgamma")
+		return this;
+
+	// Several readers of this sample may ask for it at once
+	std::lock_guard<std::mutex> lock(load_mutex);
+	if (data_sample == 0) {
+		data_sample = new DataSample("dataAllEgamma");
+		data_sample->SetChannel(channel);
+		owns_data_sample = true;
+	}
+	return data_sample;
+}
+
 double DataSample::GetDataYield(TString mode, int region, int jet_bin,
-		bool is_inclusive) {
-	DataSample* data = new DataSample("dataAllEgamma");
-	return data->GetYield(mode, region, jet_bin, is_inclusive);
+		bool is_inclusive) const {
+	return this->GetDataSample()->GetYield(mode, region, jet_bin, is_inclusive);
 }
 
 double DataSample::GetDataYieldError(TString mode, int region, int jet_bin,
-		bool is_inclusive) {
-	DataSample* data = new DataSample("dataAllEgamma");
-	return data->GetYieldError(mode, region, jet_bin, is_inclusive);
+		bool is_inclusive) const {
+	return this->GetDataSample()->GetYieldError(mode, region, jet_bin,
+			is_inclusive);
 }
+
@@ -8,16 +8,33 @@
 #include "TString.h"
 #include "TH1D.h"
 #include "TFile.h"
+#include "HistoStore.h"
+#include "YieldStore.h"
 #include <map>
+#include <vector>
+#include <atomic>
+#include <mutex>
 
 #ifndef DATASAMPLE_H_
 #define DATASAMPLE_H_
 
+class RegionYieldTable;
+class RegionCube;
+class SharedYieldSegment;
+
+// The getters are const: they load the sample on first use under its
+// load mutex and can be called from any number of threads on one shared
+// sample. The setters cannot, configure a sample before sharing it.
 class DataSample {
 public:
 	DataSample(TString sample_name_);
+	DataSample(TString sample_name_, const std::vector<TString>& input_files);
 	virtual ~DataSample();
 
+	// Data sample used for the contaminations. Not owned, if never set
+	// one is created on first use and deleted with this sample.
+	void SetDataSample(DataSample* data_sample_);
+
 	TString GetSampleName() const {
 		return sample_name;
 	}
@@ -36,31 +53,200 @@ public:
 
 	void init(void);
 
-	std::vector<TH1D*> GetHistos(TString mode);
+	// Scales every yield at load by luminosity * cross_section * k_factor
+	// / sum_of_weights, and sumw2 by its square. Units are up to the
+	// caller, e.g. pb and pb^-1. Data and samples that were scaled when
+	// they were histogrammed keep the default scale of 1.
+	void SetNormalisation(double cross_section, double k_factor,
+			double sum_of_weights, double luminosity);
+	double GetNormScale(void) const {
+		return norm_scale;
+	}
 
-	const double GetYield(TString mode, int region, int jet_bin, bool is_inclusive);
-	const double GetYieldError(TString mode, int region, int jet_bin, bool is_inclusive);
-	const double GetContamination(TString mode, int region, int jet_bin, bool is_inclusive);
-	const double GetContaminationError(TString mode, int region, int jet_bin, bool is_inclusive);
+	// Lepton channel, "el" by default. Sets the default input file
+	// ./TopD3PDHistos_<sample>_<channel>.root and the histogram suffix.
+	void SetChannel(TString channel_);
+	TString GetChannel() const {
+		return channel;
+	}
 
-	void GetYields(void);
-	void GetContaminations(void);
+	// Input files, a sample can be split over several files (periods, slices)
+	void AddInputFile(TString file_path);
+	// Exits if the pattern matches no file, rather than fall back to the
+	// default merged file
+	void AddInputFiles(TString pattern);
+	unsigned int GetNFiles(void) const;
+	TString GetInputFile(unsigned int file_index) const;
+
+	// Reads the region histograms from the columnar stores next to the
+	// ROOT files, see HistoStore, instead of the ROOT files themselves.
+	// Either every input is a store or none is.
+	void UseHistoStores(void);
+	bool UsesHistoStores(void) const;
+
+	// Shares the merged region bins with other jobs on the node through
+	// a SharedYieldSegment: the first job to load the sample publishes
+	// them, the others wait up to timeout seconds and view them in place.
+	// Not used while other histograms are requested. A job that viewed
+	// the segment reads the files again on its first per-file call.
+	void UseSharedMemory(double timeout = 300.);
+	bool UsesSharedMemory(void) const {
+		return shared_timeout > 0.;
+	}
+
+	// Regions read as h_njet_<mode>_<label>_<channel>, A to D by default
+	void SetRegionLabels(const std::vector<TString>& region_labels_);
+	unsigned int GetNRegions(void) const {
+		return region_labels.size();
+	}
+	const std::vector<TString>& GetRegionLabels(void) const {
+		return region_labels;
+	}
+
+	// Reads all region histograms from every input file and merges them.
+	// Safe to call from several threads, only the first call reads. The
+	// region bins are then kept in float, see YieldStore, and the TH1Ds
+	// read are deleted.
+	void Load(void) const;
+	bool IsLoaded(void) const {
+		return is_loaded;
+	}
+
+	// Memory held by the merged and per-file region yields
+	size_t GetYieldStoreBytes(void) const;
+
+	// Region histograms filled in memory, e.g. by EventLoop, by region
+	// histogram name. They are copied into the yield store, normalised,
+	// and replace the input files: the sample is never read from disk.
+	// A later SetNormalisation rescales them at the next load.
+	void SetRegionHistos(const std::map<TString, TH1*>& histos);
+
+	// Merged region bins, loads the sample first
+	const YieldStore& GetYieldStore(void) const;
+	// Yields of every mode, region and jet range, built on first use and
+	// shared by all readers of this sample
+	const RegionYieldTable* GetYieldTable(void) const;
+
+	// pretag and tag
+	static std::vector<TString> GetModes(void);
+	// h_njet_<mode>_<label>_<channel>, regions count from 0 here
+	TString GetRegionHistoName(TString mode, int region) const;
+
+	// Region histograms rebuilt from the yield store on first use
+	std::vector<TH1D*> GetHistos(TString mode) const;
+	std::vector<TH1D*> GetFileHistos(unsigned int file_index, TString mode) const;
+
+	// Any other histogram, e.g. the 2D MET vs etcone20 ones, is read and
+	// merged with the region histograms once requested
+	void RequestHisto(TString histo_name);
+	TH1* GetHisto(TString histo_name) const;
+	TH1* GetFileHisto(unsigned int file_index, TString histo_name) const;
+
+	// Requests the njet x MET x etcone20 histogram of every mode, see
+	// RegionCube. The region histograms are still read.
+	void UseRegionCubes(void);
+	// h_njet_met_etcone20_<mode>_<channel>
+	TString GetRegionCubeName(TString mode) const;
+	// Built on first use and shared by all readers, 0 unless requested
+	const RegionCube* GetRegionCube(TString mode) const;
+
+	const double GetYield(TString mode, int region, int jet_bin, bool is_inclusive) const;
+	const double GetYieldError(TString mode, int region, int jet_bin, bool is_inclusive) const;
+	const double GetContamination(TString mode, int region, int jet_bin, bool is_inclusive) const;
+	const double GetContaminationError(TString mode, int region, int jet_bin, bool is_inclusive) const;
+
+	// Partial yields of a single input file
+	const double GetFileYield(unsigned int file_index, TString mode, int region,
+			int jet_bin, bool is_inclusive) const;
+	const double GetFileYieldError(unsigned int file_index, TString mode,
+			int region, int jet_bin, bool is_inclusive) const;
+
+	void GetYields(void) const;
+	void GetContaminations(void) const;
 
 private:
 
 	double GetDataYield(TString mode, int region, int jet_bin,
-			bool is_inclusive);
+			bool is_inclusive) const;
 	double GetDataYieldError(TString mode, int region, int jet_bin,
-			bool is_inclusive);
-
-	typedef std::map< TString, TH1D* > HistoDatabase;
-	HistoDatabase *histo_database;
+			bool is_inclusive) const;
+	const DataSample* GetDataSample(void) const;
+
+	// Owns its histograms, copies would delete them twice
+	DataSample(const DataSample&);
+	DataSample& operator=(const DataSample&);
+
+	typedef std::map< TString, TH1* > HistoDatabase;
+
+	// Region bins summed over the store files, before rounding to float
+	struct SummedBins {
+		std::vector<double> contents;
+		std::vector<double> sumw2;
+	};
+	typedef std::map< TString, SummedBins > BinDatabase;
+
+	void ReadFile(unsigned int file_index) const;
+	void MergeFiles(void) const;
+	void FillYieldStores(void) const;
+	void MoveToYieldStore(HistoDatabase& database, YieldStore& store) const;
+	void ReadStore(unsigned int file_index) const;
+	void MergeStores(void) const;
+	void CopyStoreBins(unsigned int file_index) const;
+	void LoadFileStores(void) const;
+	void RescaleMemoryStore(void) const;
+	std::vector<TH1D*> GetHistosFromStore(HistoDatabase& database,
+			const YieldStore& store, TString mode) const;
+	TH1D* GetRegionHisto(HistoDatabase& database, const YieldStore& store,
+			TString histo_name) const;
+
+	TString GetHistoName(TString mode, TString region_label) const;
+	std::vector<TString> GetRegionHistoNames(void) const;
+	static void AddHistoToStore(YieldStore& store, TString histo_name,
+			TH1* histo, double scale);
+	static double GetYieldFromStore(const YieldStore& store,
+			TString histo_name, int jet_bin, bool is_inclusive);
+	static double GetYieldErrorFromStore(const YieldStore& store,
+			TString histo_name, int jet_bin, bool is_inclusive);
+	static void ClearDatabase(HistoDatabase& database);
+	void ClearStores(void) const;
+	void ClearRegionCubes(void) const;
+	uint64_t GetSharedKey(void) const;
+
+	// Everything the const getters load or build on first use is
+	// mutable, and only changed under load_mutex
+	mutable HistoDatabase histo_database;
+	mutable std::vector<HistoDatabase> file_histo_databases;
+	mutable std::vector<HistoStore*> file_stores;
+	mutable YieldStore yield_store;
+	mutable std::vector<YieldStore> file_yield_stores;
+	std::vector<TString> input_files;
+	std::vector<TString> region_labels;
+	std::vector<TString> requested_histos;
+	mutable std::atomic<bool> is_loaded; //!
+	mutable std::mutex load_mutex; //!
+	mutable RegionYieldTable* yield_table;
+	// By mode, they read the histograms in the database
+	mutable std::map<TString, RegionCube*> region_cubes;
+	double norm_scale;
+	mutable DataSample* data_sample;
+	mutable bool owns_data_sample;
+	bool is_in_memory;
+	// Unnormalised bins set in memory, and the scale the yield store
+	// holds them at
+	YieldStore memory_store;
+	mutable double memory_scale;
+	double shared_timeout;
+	// Attached segment the yield store views, owned
+	mutable SharedYieldSegment* shared_segment;
 
 	TString sample_name;
+	TString channel;
 	TString sample_path;
 	TString sample_full_name;
-	TFile* file;
 
 };
 
+// Samples by name, owned by whoever builds the collection
+typedef std::map<TString, DataSample*> SampleCollection;
+
 #endif /* DATASAMPLE_H_ */
@@ -24,52 +24,80 @@
 #include "DataSample.h"
 #include "ABCDReader.h"
 #include "DoABCD.h"
+#include "RunTrace.h"
 
 ClassImp(DoABCD)
 
 // Constructor
 DoABCD::DoABCD(TString mode, bool doInclusive, int jet_bin, int sysMode) :
-		mode_(mode), doInclusive_(doInclusive), jet_bin_(jet_bin), sysMode_(
-				sysMode) {
+		sample_set_(new SampleSet()), owns_sample_set_(true), readers_(0), syst_up_(
+				0), syst_down_(0), backgrounds_(0), mode_(mode), doInclusive_(
+				doInclusive), jet_bin_(jet_bin), sysMode_(sysMode) {
+	this->init();
+}
+
+DoABCD::DoABCD(TString mode, bool doInclusive, int jet_bin, int sysMode,
+		const SampleCollection& samples) :
+		sample_set_(new SampleSet(samples)), owns_sample_set_(true), readers_(
+				0), syst_up_(0), syst_down_(0), backgrounds_(0), mode_(mode), doInclusive_(
+				doInclusive), jet_bin_(jet_bin), sysMode_(sysMode) {
+	this->init();
+}
+
+DoABCD::DoABCD(TString mode, bool doInclusive, int jet_bin, int sysMode,
+		SampleSet& samples) :
+		sample_set_(&samples), owns_sample_set_(false), readers_(0), syst_up_(
+				0), syst_down_(0), backgrounds_(0), mode_(mode), doInclusive_(
+				doInclusive), jet_bin_(jet_bin), sysMode_(sysMode) {
+	this->init();
+}
 
-	listOfSamples.push_back("dataAllEgamma");
-	listOfSamples.push_back("ttbar");
-	listOfSamples.push_back("WJetsScaled");
-	listOfSamples.push_back("Zjets");
-	listOfSamples.push_back("singleTop");
-	listOfSamples.push_back("diBoson");
+// Only data gets a reader, the backgrounds are summed once here
+DoABCD::DoABCD(TString mode, bool doInclusive, int jet_bin, int sysMode,
+		DataSample* data, const SampleGroup* backgrounds) :
+		sample_set_(0), owns_sample_set_(true), readers_(0), syst_up_(0), syst_down_(
+				0), backgrounds_(backgrounds), mode_(mode), doInclusive_(
+				doInclusive), jet_bin_(jet_bin), sysMode_(sysMode) {
 
+	SampleCollection data_only;
+	data_only["dataAllEgamma"] = data;
+	sample_set_ = new SampleSet(data_only);
+
+	this->init();
+}
+
+DoABCD::DoABCD(TString mode, bool doInclusive, int jet_bin, int sysMode,
+		SampleSet& samples, const SampleGroup* backgrounds) :
+		sample_set_(&samples), owns_sample_set_(false), readers_(0), syst_up_(
+				0), syst_down_(0), backgrounds_(backgrounds), mode_(mode), doInclusive_(
+				doInclusive), jet_bin_(jet_bin), sysMode_(sysMode) {
 	this->init();
 }
 /*------------------------------------------------------------------------*/
 
 // Destructor
 DoABCD::~DoABCD() {
-	ReaderCollection::iterator iter = reader_collection.begin();
-	ReaderCollection::iterator iter_end = reader_collection.end();
+	// The shifted drivers read from the same sample set
+	delete syst_up_;
+	delete syst_down_;
 
-	for (; iter != iter_end; iter++) {
-		delete iter->second;
-	}
+	if (owns_sample_set_)
+		delete sample_set_;
 }
 /*------------------------------------------------------------------------*/
 
 void DoABCD::init(void) {
-
-	// Loop over the name of samples and create a map of Reader Objects
-	for (unsigned int sample_index = 0; sample_index != listOfSamples.size();
-			sample_index++) {
-		TString samplename = listOfSamples.at(sample_index);
-		reader_collection[samplename] = new ABCDReader(
-				new DataSample(samplename), mode_, jet_bin_, doInclusive_,
-				sysMode_);
-	}
+	readers_ = &sample_set_->GetReaders(mode_, jet_bin_, doInclusive_,
+			sysMode_);
+	if (backgrounds_ != 0)
+		background_totals_ = backgrounds_->Reduce(mode_, jet_bin_,
+				doInclusive_, sysMode_);
 	return;
 }
 
 // prints out the qcd estimate with stat error
-void DoABCD::printNdEstimateTable() {
-	TString pm = "<latex size=SMALL>\\pm</latex>";
+void DoABCD::printNdEstimateTable() const {
+	TraceSpan span("output", "DoABCD::printNdEstimateTable");
 	// Getting integrals for regions in Data plot
 	double nDEstimate = this->getNdEstimate();
 	double nDError = this->getNdError();
@@ -77,41 +105,32 @@ void DoABCD::printNdEstimateTable() {
 	// Tidying up
 	std::cout << std::setprecision(1);
 	std::cout << "| " << this->getLabel() << " | " << std::fixed << nDEstimate
-			<< pm << nDError << " (stat)" << pm << nDSystErr << "(syst) |"
-			<< std::endl;
+			<< AbcdBase::pm << nDError << " (stat)" << AbcdBase::pm
+			<< nDSystErr << "(syst) |" << std::endl;
 
 	return;
 }
 /*------------------------------------------------------------------------*/
 
 // Getting correction factors
-double DoABCD::getCorrection(int region) {
-	double correction = 0.;
+double DoABCD::getCorrection(int region) const {
+	TraceSpan span("correction", "DoABCD::getCorrection");
+	double correction = SampleSet::GetCorrection(*readers_, region);
 
 #ifdef DEBUG
-	std::cout << "--| DoABCD::Getting corrections for region: " << region << std::endl;
+	std::cout << "--| DoABCD::Correction for region " << region << ": "
+	<< correction << std::endl;
 #endif
 
-	ReaderCollection::iterator iter = reader_collection.begin();
-	ReaderCollection::iterator iter_end = reader_collection.end();
-
-	for (; iter != iter_end; iter++) {
-		if (iter->first.Contains("dataAllEgamma") == 0) {
-#ifdef DEBUG
-			std::cout << "--| DoABCD::Current Correction (" << iter->first
-			<< "): " << iter->second->GetRegionYield(region)
-			<< std::endl;
-#endif
-			correction += iter->second->GetRegionYield(region);
-		}
-	}
+	if (backgrounds_ != 0)
+		correction += background_totals_.GetYield(0, region);
 	return correction;
 }
 /*------------------------------------------------------------------------*/
 
-double DoABCD::getDataRegionYield(int region) {
+double DoABCD::getDataRegionYield(int region) const {
 	double yield = 0.;
-	yield = reader_collection["dataAllEgamma"]->GetRegionYield(region);
+	yield = SampleSet::GetDataYield(*readers_, region);
 
 #ifdef DEBUG
 	std::cout << "--| DoABCD::Data Yield: " << yield << std::endl;
@@ -122,7 +141,7 @@ double DoABCD::getDataRegionYield(int region) {
 
 // This function returns the estimate of background in the signal region
 // corrected or not corrected
-double DoABCD::getNdEstimate() {
+double DoABCD::getNdEstimate() const {
 
 	double nA_corr = this->getCorrectedRegionYield(AbcdBase::A);
 	double nB_corr = this->getCorrectedRegionYield(AbcdBase::B);
@@ -133,7 +152,7 @@ double DoABCD::getNdEstimate() {
 /*------------------------------------------------------------------------*/
 
 // This function returns the error on nD
-double DoABCD::getNdError() {
+double DoABCD::getNdError() const {
 	double nDEstimate = getNdEstimate();
 
 	double nA_ = this->getDataRegionYield(AbcdBase::A);
@@ -156,48 +175,73 @@ double DoABCD::getNdError() {
 	return errorNd;
 }
 
-double DoABCD::getNdSystError() {
-	DoABCD* up = new DoABCD(mode_, doInclusive_, jet_bin_, 2);
-	DoABCD* down = new DoABCD(mode_, doInclusive_, jet_bin_, 0);
+// The shifted drivers are built once on the same sample set and kept
+// for later calls
+void DoABCD::buildSystDrivers() const {
+	syst_up_ = new DoABCD(mode_, doInclusive_, jet_bin_, 2, *sample_set_,
+			backgrounds_);
+	syst_down_ = new DoABCD(mode_, doInclusive_, jet_bin_, 0, *sample_set_,
+			backgrounds_);
+}
+
+double DoABCD::getNdSystError() const {
+	TraceSpan span("syst", "DoABCD::getNdSystError");
+	std::call_once(syst_once_, [this]() {
+		this->buildSystDrivers();
+	});
 
-	double up_est = up->getNdEstimate();
-	double down_est = down->getNdEstimate();
+	double up_est = syst_up_->getNdEstimate();
+	double down_est = syst_down_->getNdEstimate();
 	double nominal = this->getNdEstimate();
 
 	double error = std::max(fabs(up_est - nominal), fabs(down_est - nominal));
 	return error;
 }
 
-double DoABCD::getCorrectedRegionYield(int region) {
+double DoABCD::getCorrectedRegionYield(int region) const {
 	double yield = this->getDataRegionYield(region);
 	double corr = this->getCorrection(region);
 	return (yield - corr);
 }
 
 // Returns the total corrected error
-double DoABCD::getRegionError(int region) {
-	double sumError = 0.;
-	double regError = 0.;
-	ReaderCollection::iterator iter = reader_collection.begin();
-	ReaderCollection::iterator iter_end = reader_collection.end();
-
-	for (; iter != iter_end; iter++) {
-		regError = iter->second->GetRegionError(region);
-		sumError += regError * regError;
-	}
+double DoABCD::getRegionError(int region) const {
+	double sumError = SampleSet::GetRegionError(*readers_, region);
+	sumError *= sumError;
+	if (backgrounds_ != 0)
+		sumError += background_totals_.GetVariance(0, region);
 
 	return sqrt(sumError);
 }
 /*--------------------------------------------------------------------*/
 
-TString DoABCD::getLabel() {
-	TString suffix = "";
-	if (doInclusive_ != 0)
-		suffix = "inc ";
+// One row per group, indented by depth, with its share of the correction
+void DoABCD::printGroupTable() const {
+	TraceSpan span("output", "DoABCD::printGroupTable");
+	if (backgrounds_ == 0) {
+		std::cout << "DoABCD::printGroupTable - No background groups"
+				<< std::endl;
+		return;
+	}
 
-	// 3 jet inc (pretag)
-	TString label = Form("%i jet %s(%s)", jet_bin_, suffix.Data(),
-			mode_.Data());
+	const SampleGroup::Totals& totals = background_totals_;
+	std::cout << std::setprecision(1) << std::fixed;
+	std::cout << "| *Group* | *A* | *B* | *C* | *D* |" << std::endl;
+	for (unsigned int node = 0; node != totals.names.size(); node++) {
+		std::cout << "| " << std::string(2 * totals.depths[node], ' ')
+				<< totals.names[node] << " | ";
+		for (int region = AbcdBase::A; region <= AbcdBase::D; region++) {
+			std::cout << totals.GetYield(node, region) << AbcdBase::pm
+					<< sqrt(totals.GetVariance(node, region)) << " | ";
+		}
+		std::cout << std::endl;
+	}
+	return;
+}
+/*------------------------------------------------------------------------*/
 
-	return label;
+TString DoABCD::getLabel() const {
+	// 3 jet inc (pretag)
+	return TString::Format("%s(%s)",
+			SampleSet::GetJetLabel(jet_bin_, doInclusive_).Data(), mode_.Data());
 }
@@ -11,16 +11,28 @@
 #define DOABCD_H_
 
 #include <map>
+#include <mutex>
 #include "ABCDReader.h"
 #include "DataSample.h"
-
-typedef std::map<TString, ABCDReader*> ReaderCollection;
+#include "SampleSet.h"
+#include "SampleGroup.h"
 
 class DoABCD {
 
 private:
-	ReaderCollection reader_collection;
-	std::vector<std::string> listOfSamples;
+	// Owns the systematic variations, and the sample set unless it was
+	// passed in
+	SampleSet* sample_set_; //!
+	bool owns_sample_set_;
+	// Readers of this configuration, owned by the sample set
+	const ReaderCollection* readers_; //!
+	// Built once by the first caller of getNdSystError
+	mutable std::once_flag syst_once_; //!
+	mutable DoABCD* syst_up_; //!
+	mutable DoABCD* syst_down_; //!
+	// Background tree used instead of the MC readers, not owned
+	const SampleGroup* backgrounds_; //!
+	SampleGroup::Totals background_totals_; //!
 
 	TString mode_;
 	bool doInclusive_;
@@ -28,24 +40,49 @@ private:
 	int sysMode_;
 
 	void init(void);
+	void buildSystDrivers(void) const;
+	// Shifted drivers of a SampleGroup driver, on its data only set
+	DoABCD(TString mode, bool doInclusive_, int jet_bin, int sysMode,
+			SampleSet& samples, const SampleGroup* backgrounds);
+
+	DoABCD(const DoABCD&);
+	DoABCD& operator=(const DoABCD&);
 
 public:
+	// Every getter is const and only reads the readers, the shifted
+	// drivers are built under a once flag. A constructed driver can be
+	// shared by any number of threads; its samples must not be reloaded
+	// or reconfigured meanwhile.
 	DoABCD(TString mode = "tag", bool doInclusive_ = false, int jet_bin = 3, int sysMode = 1);
+	// Reads from already loaded samples, which have to outlive the driver
+	DoABCD(TString mode, bool doInclusive_, int jet_bin, int sysMode,
+			const SampleCollection& samples);
+	// Shares the samples and readers of a set, which has to outlive the
+	// driver
+	DoABCD(TString mode, bool doInclusive_, int jet_bin, int sysMode,
+			SampleSet& samples);
+	// Corrections from a tree of background groups instead of the five
+	// MC samples, see SampleGroup. Both have to be loaded and to outlive
+	// the driver.
+	DoABCD(TString mode, bool doInclusive_, int jet_bin, int sysMode,
+			DataSample* data, const SampleGroup* backgrounds);
 	virtual ~DoABCD();
-	void printNdEstimateTable(void);
+	void printNdEstimateTable(void) const;
+	// Correction of every background group, only with a SampleGroup
+	void printGroupTable(void) const;
 
 
-	double getDataRegionYield(int region);
-	double getCorrection(int region);
+	double getDataRegionYield(int region) const;
+	double getCorrection(int region) const;
 
-	double getCorrectedRegionYield(int region);
-	double getRegionError(int region);
+	double getCorrectedRegionYield(int region) const;
+	double getRegionError(int region) const;
 
-	double getNdEstimate(void);
-	double getNdError(void);
-	double getNdSystError(void);
+	double getNdEstimate(void) const;
+	double getNdError(void) const;
+	double getNdSystError(void) const;
 
-	TString getLabel(void);
+	TString getLabel(void) const;
 
 	ClassDef(DoABCD,1)
 };
@@ -9,57 +9,76 @@
 #include <iostream>
 #include "math.h"
 #include "AbcdBase.h"
+#include "RunTrace.h"
 #include <iomanip>
 
 DoRSMT::DoRSMT(int jet_bin = 3, bool is_inclusive = true, int sys_mode = 1) :
+		sample_set_(new SampleSet()), //
+		owns_sample_set_(true), //
+		reader_collection_pretag(0), //
+		reader_collection_tag(0), //
+		syst_up_(0), //
+		syst_down_(0), //
 		jet_bin_(jet_bin), //
 		is_inclusive_(is_inclusive), //
 		sys_mode_(sys_mode) //
 {
-	list_of_samples.push_back("dataAllEgamma");
-	list_of_samples.push_back("ttbar");
-	list_of_samples.push_back("WJetsScaled");
-	list_of_samples.push_back("Zjets");
-	list_of_samples.push_back("singleTop");
-	list_of_samples.push_back("diBoson");
+	this->init();
+}
 
+DoRSMT::DoRSMT(int jet_bin, bool is_inclusive, int sys_mode,
+		const SampleCollection& samples) :
+		sample_set_(new SampleSet(samples)), //
+		owns_sample_set_(true), //
+		reader_collection_pretag(0), //
+		reader_collection_tag(0), //
+		syst_up_(0), //
+		syst_down_(0), //
+		jet_bin_(jet_bin), //
+		is_inclusive_(is_inclusive), //
+		sys_mode_(sys_mode) //
+{
 	this->init();
 }
 
-DoRSMT::~DoRSMT() {
-	ReaderCollection::iterator iter = reader_collection_pretag.begin();
-	ReaderCollection::iterator iter_end = reader_collection_pretag.end();
+DoRSMT::DoRSMT(int jet_bin, bool is_inclusive, int sys_mode,
+		SampleSet& samples) :
+		sample_set_(&samples), //
+		owns_sample_set_(false), //
+		reader_collection_pretag(0), //
+		reader_collection_tag(0), //
+		syst_up_(0), //
+		syst_down_(0), //
+		jet_bin_(jet_bin), //
+		is_inclusive_(is_inclusive), //
+		sys_mode_(sys_mode) //
+{
+	this->init();
+}
 
-	for (; iter != iter_end; iter++) {
-		delete iter->second;
+DoRSMT::~DoRSMT() {
+	// The shifted drivers and the pretag ABCD read from the same set
+	delete syst_up_;
+	delete syst_down_;
+	for (unsigned int abcd_idx = 0; abcd_idx != pretag_abcds_.size();
+			abcd_idx++) {
+		delete pretag_abcds_.at(abcd_idx);
 	}
 
-	ReaderCollection::iterator itertwo = reader_collection_tag.begin();
-	ReaderCollection::iterator itertwo_end = reader_collection_tag.end();
-
-	for (; itertwo != itertwo_end; itertwo++) {
-		delete itertwo->second;
-	}
+	if (owns_sample_set_)
+		delete sample_set_;
 }
 
 void DoRSMT::init() {
-
-	// Loop over the name of samples and create a map of Reader Objects
-	for (unsigned int sample_index = 0; sample_index != list_of_samples.size();
-			sample_index++) {
-		TString samplename = list_of_samples.at(sample_index);
-
-		reader_collection_pretag[samplename] = new ABCDReader(
-				new DataSample(samplename), "pretag", jet_bin_, is_inclusive_,
-				sys_mode_);
-		reader_collection_tag[samplename] = new ABCDReader(
-				new DataSample(samplename), "tag", jet_bin_, is_inclusive_,
-				sys_mode_);
-	}
+	reader_collection_pretag = &sample_set_->GetReaders("pretag", jet_bin_,
+			is_inclusive_, sys_mode_);
+	reader_collection_tag = &sample_set_->GetReaders("tag", jet_bin_,
+			is_inclusive_, sys_mode_);
 	return;
 } // End init
 
-void DoRSMT::PrintRsmtTable() {
+void DoRSMT::PrintRsmtTable() const {
+	TraceSpan span("output", "DoRSMT::PrintRsmtTable");
 
 	double r_smt_A = 100 * this->GetRsmt(AbcdBase::A);
 	double r_smt_B = 100 * this->GetRsmt(AbcdBase::B);
@@ -89,7 +108,8 @@ void DoRSMT::PrintRsmtTable() {
 }
 
 // Prints out the qcd estimate with stat error
-void DoRSMT::PrintEstimateTable(TString mode) {
+void DoRSMT::PrintEstimateTable(TString mode) const {
+	TraceSpan span("output", "DoRSMT::PrintEstimateTable", mode.Data());
 
 	// Getting integrals for regions in Data plot
 #ifdef DEBUG
@@ -100,7 +120,8 @@ void DoRSMT::PrintEstimateTable(TString mode) {
 
 	if (mode.Contains("pretag")) {
 		nD_estimate = this->GetPretagEstimate();
-		nD_error = nD_estimate * 0.5;
+		nD_error = this->GetPretagEstimateStatError();
+		nD_error_syst = this->GetPretagEstimateSystError();
 	} else {
 		nD_estimate = this->GetTagEstimate();
 		nD_error = this->GetTagEstimateStatError();
@@ -118,14 +139,9 @@ void DoRSMT::PrintEstimateTable(TString mode) {
 /*-----*/
 
 // Get Data Yield
-double DoRSMT::GetDataRegionYield(TString mode, int region) {
+double DoRSMT::GetDataRegionYield(TString mode, int region) const {
 	double yield = 0.;
-	if (mode.Contains("pretag")) {
-		yield = reader_collection_pretag["dataAllEgamma"]->GetRegionYield(
-				region);
-	} else {
-		yield = reader_collection_tag["dataAllEgamma"]->GetRegionYield(region);
-	}
+	yield = SampleSet::GetDataYield(this->GetCollection(mode), region);
 #ifdef DEBUG
 	std::cout << "DoRSMT::GetDataRegionYield - " << mode << " yield (" << region
 	<< "): " << yield << std::endl;
@@ -135,38 +151,22 @@ double DoRSMT::GetDataRegionYield(TString mode, int region) {
 /*-----*/
 
 // Get Corrections
-double DoRSMT::GetCorrection(TString mode, int region) {
-
-	ReaderCollection temp_collection = this->GetCollection(mode);
-	double correction = 0.;
-
-#ifdef DEBUG
-	std::cout << "--| DoRSMT::Getting corrections for region: " << region
-	<< std::endl;
-#endif
-
-	ReaderCollection::iterator iter = temp_collection.begin();
-	ReaderCollection::iterator iter_end = temp_collection.end();
-
-	for (; iter != iter_end; iter++) {
-		if (iter->first.Contains("dataAllEgamma") == 0) {
+double DoRSMT::GetCorrection(TString mode, int region) const {
+	TraceSpan span("correction", "DoRSMT::GetCorrection", mode.Data());
+	double correction = SampleSet::GetCorrection(this->GetCollection(mode),
+			region);
 
 #ifdef DEBUG
-			std::cout << "--| DoRSMT::Current Correction (" << iter->first
-			<< "): " << iter->second->GetRegionYield(region)
-			<< std::endl;
+	std::cout << "--| DoRSMT::Correction for region " << region << ": "
+	<< correction << std::endl;
 #endif
 
-			correction += iter->second->GetRegionYield(region);
-		}
-	}
-
 	return correction;
 }
 /*-----*/
 
 // Returns corrected yield for region
-double DoRSMT::GetCorrectedRegionYield(TString mode, int region) {
+double DoRSMT::GetCorrectedRegionYield(TString mode, int region) const {
 	double yield = this->GetDataRegionYield(mode, region);
 	double correction = this->GetCorrection(mode, region);
 	return yield - correction;
@@ -174,19 +174,8 @@ double DoRSMT::GetCorrectedRegionYield(TString mode, int region) {
 /*-----*/
 
 // Returns Region Error
-double DoRSMT::GetRegionError(TString mode, int region) {
-	ReaderCollection temp_collection = this->GetCollection(mode);
-	double sumError = 0.;
-	double regError = 0.;
-
-	ReaderCollection::iterator iter = temp_collection.begin();
-	ReaderCollection::iterator iter_end = temp_collection.end();
-
-	for (; iter != iter_end; iter++) {
-		regError = iter->second->GetRegionError(region);
-		sumError += regError * regError;
-	}
-	return sqrt(sumError);
+double DoRSMT::GetRegionError(TString mode, int region) const {
+	return SampleSet::GetRegionError(this->GetCollection(mode), region);
 }
 /*-----*/
 
@@ -194,14 +183,14 @@ double DoRSMT::GetRegionError(TString mode, int region) {
 // RSMT SECTION
 //
 // Returns Rsmt for region
-double DoRSMT::GetRsmt(int region) {
+double DoRSMT::GetRsmt(int region) const {
 	return this->GetCorrectedRegionYield("tag", region)
 			/ this->GetCorrectedRegionYield("pretag", region);
 }
 /*-----*/
 
 // Returns Rsmt Error in region
-double DoRSMT::GetRsmtStatError(int region) {
+double DoRSMT::GetRsmtStatError(int region) const {
 	double r_smt = this->GetRsmt(region);
 	double pretag_yield = this->GetCorrectedRegionYield("pretag", region);
 	return sqrt(r_smt * (1 - r_smt) / pretag_yield);
@@ -209,18 +198,20 @@ double DoRSMT::GetRsmtStatError(int region) {
 /*-----*/
 
 // Returns Rsmt Syst Error in region
-double DoRSMT::GetRsmtSystError(int region) {
-	DoRSMT* up = new DoRSMT(jet_bin_, is_inclusive_, 2);
-	DoRSMT* down = new DoRSMT(jet_bin_, is_inclusive_, 0);
-	double rsmt_up = up->GetRsmt(region);
-	double rsmt_down = down->GetRsmt(region);
+// The shifted drivers are built once on the same samples and kept for
+// later calls
+double DoRSMT::GetRsmtSystError(int region) const {
+	TraceSpan span("syst", "DoRSMT::GetRsmtSystError");
+	std::call_once(syst_once_, [this]() {
+		syst_up_ = new DoRSMT(jet_bin_, is_inclusive_, 2, *sample_set_);
+		syst_down_ = new DoRSMT(jet_bin_, is_inclusive_, 0, *sample_set_);
+	});
+	double rsmt_up = syst_up_->GetRsmt(region);
+	double rsmt_down = syst_down_->GetRsmt(region);
 	double nominal = this->GetRsmt(region);
 
 	double error = std::max(fabs(rsmt_up - nominal), fabs(rsmt_down - nominal));
 
-	delete up;
-	delete down;
-
 	return error;
 }
 /*-----*/
@@ -229,7 +220,7 @@ double DoRSMT::GetRsmtSystError(int region) {
 // RSMTWGT SECTION
 //
 // Returns Weighted Rsmt
-double DoRSMT::GetRsmtWgt() {
+double DoRSMT::GetRsmtWgt() const {
 
 	double r_smt_A = this->GetRsmt(AbcdBase::A);
 	double r_smt_B = this->GetRsmt(AbcdBase::B);
@@ -240,13 +231,13 @@ double DoRSMT::GetRsmtWgt() {
 /*-----*/
 
 // Get stat error on RsmtWGT
-double DoRSMT::GetRsmtWgtStatErr() {
+double DoRSMT::GetRsmtWgtStatErr() const {
 	return sqrt(this->GetSumOfErrors());
 } // End of GetRsmtWgtStatErr
 /*-----*/
 
 // Get syst error on RsmtWGT
-double DoRSMT::GetRsmtWgtSystErr() {
+double DoRSMT::GetRsmtWgtSystErr() const {
 
 	double r_smt_A = this->GetRsmt(AbcdBase::A);
 	double r_smt_B = this->GetRsmt(AbcdBase::B);
@@ -266,7 +257,7 @@ double DoRSMT::GetRsmtWgtSystErr() {
 /*-----*/
 
 // Returns sum of errors
-double DoRSMT::GetSumOfErrors() {
+double DoRSMT::GetSumOfErrors() const {
 	double r_smt_err_A = this->GetRsmtStatError(AbcdBase::A);
 	double r_smt_err_B = this->GetRsmtStatError(AbcdBase::B);
 	double r_smt_err_C = this->GetRsmtStatError(AbcdBase::C);
@@ -277,7 +268,7 @@ double DoRSMT::GetSumOfErrors() {
 /*-----*/
 
 // Returns the estimate based on the pretag * rsmt
-double DoRSMT::GetTagEstimate(void) {
+double DoRSMT::GetTagEstimate(void) const {
 
 	double pre_estimate = this->GetPretagEstimate();
 	double rsmt_wgt = this->GetRsmtWgt();
@@ -292,22 +283,25 @@ double DoRSMT::GetTagEstimate(void) {
 } // End of GetTagEstimate
 /*-----*/
 
-// Assumes a 50% uncertainty
-double DoRSMT::GetTagEstimateStatError(void) {
+// Stat errors of Rsmt Wgt and of the pretag estimate
+double DoRSMT::GetTagEstimateStatError(void) const {
 	double rsmt_bit = this->GetRsmtWgtStatErr() / this->GetRsmtWgt();
+	double pretag_bit = this->GetPretagEstimateStatError()
+			/ this->GetPretagEstimate();
 	double estimate = this->GetTagEstimate();
 
-	return estimate * rsmt_bit;
+	return estimate * sqrt(rsmt_bit * rsmt_bit + pretag_bit * pretag_bit);
 } //
 /*-----*/
 
-// TODO - Fill this in.
-double DoRSMT::GetTagEstimateSystError(void) {
+// Syst errors of Rsmt Wgt and of the pretag estimate
+double DoRSMT::GetTagEstimateSystError(void) const {
+	TraceSpan span("syst", "DoRSMT::GetTagEstimateSystError");
 
 	double r_smt_wgt_err = this->GetRsmtWgtSystErr();
 
 	double pretag_estimate = this->GetPretagEstimate();
-	double pretag_estimate_err = pretag_estimate / 2;
+	double pretag_estimate_err = this->GetPretagEstimateSystError();
 	double pretag_estimate_bit = pretag_estimate_err / pretag_estimate;
 
 	double tag_estimate = this->GetTagEstimate();
@@ -320,41 +314,73 @@ double DoRSMT::GetTagEstimateSystError(void) {
 /*-----*/
 
 //
-TString DoRSMT::GetLabel() {
-	TString suffix = "";
-	if (is_inclusive_ != 0)
-		suffix = "inc ";
-
-// 3 jet inc (pretag)
-	TString label = Form("%i jet %s", jet_bin_, suffix.Data());
-
-	return label;
+TString DoRSMT::GetLabel() const {
+	// 3 jet inc
+	return SampleSet::GetJetLabel(jet_bin_, is_inclusive_);
 } //
 
-ReaderCollection& DoRSMT::GetCollection(TString mode) {
+const ReaderCollection& DoRSMT::GetCollection(TString mode) const {
 	if (mode.Contains("pretag")) {
-		return reader_collection_pretag;
+		return *reader_collection_pretag;
 	} else {
-		return reader_collection_tag;
+		return *reader_collection_tag;
 	}
 } //
 
-// Get pretag Estimates
-double DoRSMT::GetPretagEstimate() {
-
-	int array_bin = jet_bin_ - 1;
+// Pretag ABCD on the samples and pretag readers already loaded for Rsmt.
+// Below 4 jets an inclusive selection is the sum of its exclusive bins
+// and of 4 jets and more, each with its own ABCD estimate, as in the
+// pretag tables.
+const std::vector<DoABCD*>& DoRSMT::GetPretagAbcds() const {
+	std::call_once(pretag_once_, [this]() {
+		if (is_inclusive_ == 0 || jet_bin_ >= 4) {
+			pretag_abcds_.push_back(
+					new DoABCD("pretag", is_inclusive_, jet_bin_, sys_mode_,
+							*sample_set_));
+			return;
+		}
+		for (int jet_bin = jet_bin_; jet_bin != 4; jet_bin++) {
+			pretag_abcds_.push_back(
+					new DoABCD("pretag", false, jet_bin, sys_mode_,
+							*sample_set_));
+		}
+		pretag_abcds_.push_back(
+				new DoABCD("pretag", true, 4, sys_mode_, *sample_set_));
+	});
+	return pretag_abcds_;
+}
 
-	double estimates[] = { 110678, 29323, 7924, 2377, 3434 };
+// Get pretag Estimates
+double DoRSMT::GetPretagEstimate() const {
+	const std::vector<DoABCD*>& abcds = this->GetPretagAbcds();
 	double estimate = 0.;
-	if (is_inclusive_ != 1) {
-		estimate = estimates[array_bin];
-	} else {
-		if (jet_bin_ == 3) {
-			estimate = estimates[2] + estimates[4];
-		} else if (jet_bin_ == 4) {
-			estimate = estimates[4];
-		}
+	for (unsigned int abcd_idx = 0; abcd_idx != abcds.size(); abcd_idx++) {
+		estimate += abcds.at(abcd_idx)->getNdEstimate();
 	}
 	return estimate;
 }
 /*-----*/
+
+// The jet bins are independent, their stat errors add in quadrature
+double DoRSMT::GetPretagEstimateStatError() const {
+	const std::vector<DoABCD*>& abcds = this->GetPretagAbcds();
+	double sum_sq = 0.;
+	for (unsigned int abcd_idx = 0; abcd_idx != abcds.size(); abcd_idx++) {
+		double error = abcds.at(abcd_idx)->getNdError();
+		sum_sq += error * error;
+	}
+	return sqrt(sum_sq);
+}
+/*-----*/
+
+// The normalisation shifts are common to all jet bins, so their syst
+// errors add linearly
+double DoRSMT::GetPretagEstimateSystError() const {
+	const std::vector<DoABCD*>& abcds = this->GetPretagAbcds();
+	double error = 0.;
+	for (unsigned int abcd_idx = 0; abcd_idx != abcds.size(); abcd_idx++) {
+		error += abcds.at(abcd_idx)->getNdSystError();
+	}
+	return error;
+}
+/*-----*/
@@ -9,56 +9,88 @@
 #define DORSMT_H_
 
 #include "ABCDReader.h"
+#include "DoABCD.h"
+#include "SampleSet.h"
 #include <map>
-
-typedef std::map<TString, ABCDReader*> ReaderCollection;
+#include <vector>
+#include <mutex>
 
 class DoRSMT {
 
 private:
-	ReaderCollection reader_collection_pretag;
-	ReaderCollection reader_collection_tag;
-
-	std::vector<std::string> list_of_samples;
+	// Owns the shifted and pretag drivers, and the sample set unless it
+	// was passed in
+	SampleSet* sample_set_;
+	bool owns_sample_set_;
+	// Readers of the pretag and tag modes, owned by the sample set
+	const ReaderCollection* reader_collection_pretag;
+	const ReaderCollection* reader_collection_tag;
+
+	// Built once by the first caller that needs them
+	mutable std::once_flag syst_once_;
+	mutable DoRSMT* syst_up_;
+	mutable DoRSMT* syst_down_;
+	// ABCD estimates in the pretag sample, built on the same samples: one
+	// per exclusive bin and one for 4 jets and more, see GetPretagAbcds
+	mutable std::once_flag pretag_once_;
+	mutable std::vector<DoABCD*> pretag_abcds_;
 
 	int jet_bin_;
 	bool is_inclusive_;
 	int sys_mode_;
 
 	void init(void);
-	double GetPretagEstimate(void);
-	TString GetLabel(void);
-	ReaderCollection& GetCollection(TString mode);
 
-	double GetSumOfErrors();
+	DoRSMT(const DoRSMT&);
+	DoRSMT& operator=(const DoRSMT&);
+	const std::vector<DoABCD*>& GetPretagAbcds(void) const;
+	TString GetLabel(void) const;
+	const ReaderCollection& GetCollection(TString mode) const;
+
+	double GetSumOfErrors() const;
 
 public:
+	// Every getter is const and only reads the readers, the shifted and
+	// pretag drivers are built under once flags. A constructed driver can
+	// be shared by any number of threads; its samples must not be
+	// reloaded or reconfigured meanwhile.
 	DoRSMT(int jet_bin, bool is_inclusive, int sys_mode);
+	// Reads from already loaded samples, which have to outlive the driver
+	DoRSMT(int jet_bin, bool is_inclusive, int sys_mode,
+			const SampleCollection& samples);
+	// Shares the samples and readers of a set, which has to outlive the
+	// driver
+	DoRSMT(int jet_bin, bool is_inclusive, int sys_mode, SampleSet& samples);
 	virtual ~DoRSMT();
 
-	void PrintEstimateTable(TString mode);
-	void PrintRsmtTable(void);
+	void PrintEstimateTable(TString mode) const;
+	void PrintRsmtTable(void) const;
 
 	// Region yields correction section
-	double GetDataRegionYield(TString mode, int region);
-	double GetCorrection(TString mode, int region);
-	double GetCorrectedRegionYield(TString mode, int region);
-	double GetRegionError(TString mode, int region);
+	double GetDataRegionYield(TString mode, int region) const;
+	double GetCorrection(TString mode, int region) const;
+	double GetCorrectedRegionYield(TString mode, int region) const;
+	double GetRegionError(TString mode, int region) const;
 
 	// RsmtRegion section
-	double GetRsmt(int region);
-	double GetRsmtStatError(int region);
-	double GetRsmtSystError(int region);
+	double GetRsmt(int region) const;
+	double GetRsmtStatError(int region) const;
+	double GetRsmtSystError(int region) const;
 
 	// RsmtWgt Section
-	double GetRsmtWgt(void);
-	double GetRsmtWgtStatErr(void);
-	double GetRsmtWgtSystErr(void);
+	double GetRsmtWgt(void) const;
+	double GetRsmtWgtStatErr(void) const;
+	double GetRsmtWgtSystErr(void) const;
+
+	// Pretag ABCD Section
+	double GetPretagEstimate(void) const;
+	double GetPretagEstimateStatError(void) const;
+	double GetPretagEstimateSystError(void) const;
 
 	// Rsmt Estimate Section
-	double GetTagEstimate(void);
-	double GetTagEstimateSystError(void);
-	double GetTagEstimateStatError(void);
+	double GetTagEstimate(void) const;
+	double GetTagEstimateSystError(void) const;
+	double GetTagEstimateStatError(void) const;
 };
 
 #endif /* DORSMT_H_ */
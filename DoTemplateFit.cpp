@@ -0,0 +1,227 @@
+/*
+ * DoTemplateFit.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include "DoTemplateFit.h"
+#include "ABCDReader.h"
+#include "AbcdBase.h"
+#include "BinnedLikelihood.h"
+#include <iostream>
+#include <iomanip>
+#include <math.h>
+
+namespace {
+// Jet bins 1 .. 18 are histogram bins 2 .. 19, as for the inclusive yields
+const int kFirstJetBin = 1;
+const int kLastJetBin = 18;
+}
+
+DoTemplateFit::DoTemplateFit(TString mode, bool doInclusive, int jet_bin,
+		int sysMode) :
+		sample_set_(new SampleSet()), owns_sample_set_(true), syst_up_(0), syst_down_(
+				0), mode_(mode), doInclusive_(doInclusive), jet_bin_(jet_bin), sysMode_(
+				sysMode), is_fitted_(false), qcd_scale_(0.), qcd_scale_error_(
+				0.) {
+}
+
+DoTemplateFit::DoTemplateFit(TString mode, bool doInclusive, int jet_bin,
+		int sysMode, const SampleCollection& samples) :
+		sample_set_(new SampleSet(samples)), owns_sample_set_(true), syst_up_(
+				0), syst_down_(0), mode_(mode), doInclusive_(doInclusive), jet_bin_(
+				jet_bin), sysMode_(sysMode), is_fitted_(false), qcd_scale_(0.), qcd_scale_error_(
+				0.) {
+}
+
+DoTemplateFit::DoTemplateFit(TString mode, bool doInclusive, int jet_bin,
+		int sysMode, SampleSet& samples) :
+		sample_set_(&samples), owns_sample_set_(false), syst_up_(0), syst_down_(
+				0), mode_(mode), doInclusive_(doInclusive), jet_bin_(jet_bin), sysMode_(
+				sysMode), is_fitted_(false), qcd_scale_(0.), qcd_scale_error_(
+				0.) {
+}
+
+DoTemplateFit::~DoTemplateFit() {
+	// The shifted drivers read from the same sample set
+	delete syst_up_;
+	delete syst_down_;
+
+	if (owns_sample_set_)
+		delete sample_set_;
+}
+
+int DoTemplateFit::getLastJetBin() const {
+	return (doInclusive_ != 0) ? kLastJetBin : jet_bin_;
+}
+
+// Exclusive yields of one region for every fitted jet bin, scaled for
+// the normalisation systematic. DataSample regions count from 0.
+std::vector<double> DoTemplateFit::getRegionBins(DataSample* sample,
+		int region) {
+	double factor = ABCDReader::GetSampleSystFactor(sample->GetSampleName(),
+			sysMode_);
+	std::vector<double> bins;
+	for (int jet_bin = kFirstJetBin; jet_bin <= kLastJetBin; jet_bin++) {
+		bins.push_back(
+				factor * sample->GetYield(mode_, region - 1, jet_bin, false));
+	}
+	return bins;
+}
+
+std::vector<double> DoTemplateFit::getRegionBinErrors(DataSample* sample,
+		int region) {
+	std::vector<double> bins;
+	for (int jet_bin = kFirstJetBin; jet_bin <= kLastJetBin; jet_bin++) {
+		bins.push_back(sample->GetYieldError(mode_, region - 1, jet_bin, false));
+	}
+	return bins;
+}
+
+void DoTemplateFit::fit() {
+	if (is_fitted_)
+		return;
+
+	// Samples still being read in the background are waited for on the
+	// first yield
+	const SampleCollection& samples = sample_set_->GetSamples();
+	DataSample* data = sample_set_->GetDataSample();
+	unsigned int n_bins = kLastJetBin - kFirstJetBin + 1;
+
+	// QCD template: data minus MC in the non-isolated region C
+	qcd_template_ = this->getRegionBins(data, AbcdBase::C);
+	std::vector<double> template_variance(n_bins, 0.);
+	SampleCollection::const_iterator iter = samples.begin();
+	SampleCollection::const_iterator iter_end = samples.end();
+	for (; iter != iter_end; iter++) {
+		std::vector<double> errors = this->getRegionBinErrors(iter->second,
+				AbcdBase::C);
+		for (unsigned int bin = 0; bin != n_bins; bin++) {
+			template_variance[bin] += errors[bin] * errors[bin];
+		}
+		if (SampleSet::IsData(iter->first) != 0)
+			continue;
+		std::vector<double> correction = this->getRegionBins(iter->second,
+				AbcdBase::C);
+		for (unsigned int bin = 0; bin != n_bins; bin++) {
+			qcd_template_[bin] -= correction[bin];
+		}
+	}
+
+	qcd_template_error_.assign(n_bins, 0.);
+	for (unsigned int bin = 0; bin != n_bins; bin++) {
+		if (qcd_template_[bin] < 0.)
+			qcd_template_[bin] = 0.;
+		qcd_template_error_[bin] = sqrt(template_variance[bin]);
+	}
+
+	// Fit the data in region D
+	BinnedLikelihood likelihood(this->getRegionBins(data, AbcdBase::D));
+	unsigned int qcd_param = likelihood.AddTemplate(qcd_template_);
+	for (iter = samples.begin(); iter != iter_end; iter++) {
+		if (SampleSet::IsData(iter->first) != 0)
+			continue;
+		std::vector<double> background = this->getRegionBins(iter->second,
+				AbcdBase::D);
+		double norm_error = ABCDReader::GetSampleNormError(iter->first);
+		if (norm_error > 0.)
+			likelihood.AddTemplate(background, norm_error);
+		else
+			likelihood.AddFixed(background);
+	}
+
+	std::vector<double> params(likelihood.GetNParameters(), 1.);
+	std::vector<double> covariance;
+	// An unconverged fit has no covariance and no estimate to publish
+	if (!likelihood.Minimise(params, covariance)) {
+		std::cout << "DoTemplateFit::fit - Fit did not converge for "
+				<< this->getLabel() << std::endl;
+		exit(-1);
+	}
+	double variance = covariance[qcd_param * likelihood.GetNParameters()
+			+ qcd_param];
+	if (!(variance >= 0.)) {
+		std::cout << "DoTemplateFit::fit - Negative QCD scale variance for "
+				<< this->getLabel() << std::endl;
+		exit(-1);
+	}
+
+	qcd_scale_ = params[qcd_param];
+	qcd_scale_error_ = sqrt(variance);
+	is_fitted_ = true;
+}
+
+double DoTemplateFit::getQcdScale() {
+	this->fit();
+	return qcd_scale_;
+}
+
+double DoTemplateFit::getQcdScaleError() {
+	this->fit();
+	return qcd_scale_error_;
+}
+
+// Scaled template summed over the jet bins of this estimate
+double DoTemplateFit::getNdEstimate() {
+	this->fit();
+	double sum = 0.;
+	for (int jet_bin = jet_bin_; jet_bin <= this->getLastJetBin(); jet_bin++) {
+		sum += qcd_template_[jet_bin - kFirstJetBin];
+	}
+	return qcd_scale_ * sum;
+}
+
+// Fit error on the scale and stat error of the template
+double DoTemplateFit::getNdError() {
+	this->fit();
+	double sum = 0.;
+	double variance = 0.;
+	for (int jet_bin = jet_bin_; jet_bin <= this->getLastJetBin(); jet_bin++) {
+		sum += qcd_template_[jet_bin - kFirstJetBin];
+		variance += qcd_template_error_[jet_bin - kFirstJetBin]
+				* qcd_template_error_[jet_bin - kFirstJetBin];
+	}
+	double scale_part = qcd_scale_error_ * sum;
+	return sqrt(scale_part * scale_part + qcd_scale_ * qcd_scale_ * variance);
+}
+
+// The shifted drivers are built once on the same samples and kept for
+// later calls
+double DoTemplateFit::getNdSystError() {
+	if (syst_up_ == 0)
+		syst_up_ = new DoTemplateFit(mode_, doInclusive_, jet_bin_, 2,
+				*sample_set_);
+	if (syst_down_ == 0)
+		syst_down_ = new DoTemplateFit(mode_, doInclusive_, jet_bin_, 0,
+				*sample_set_);
+
+	double up_est = syst_up_->getNdEstimate();
+	double down_est = syst_down_->getNdEstimate();
+	double nominal = this->getNdEstimate();
+
+	return std::max(fabs(up_est - nominal), fabs(down_est - nominal));
+}
+
+void DoTemplateFit::printNdEstimateTable() {
+	double nDEstimate = this->getNdEstimate();
+	double nDError = this->getNdError();
+	double nDSystErr = this->getNdSystError();
+
+	std::cout << std::setprecision(1);
+	std::cout << "| " << this->getLabel() << " | " << std::fixed << nDEstimate
+			<< AbcdBase::pm << nDError << " (stat)" << AbcdBase::pm
+			<< nDSystErr << "(syst) |" << std::endl;
+	return;
+}
+
+TString DoTemplateFit::getLabel() {
+	TString suffix = "";
+	if (doInclusive_ != 0)
+		suffix = "inc ";
+
+	// 3 jet inc (tag)
+	TString label = TString::Format("%i jet %s(%s)", jet_bin_, suffix.Data(),
+			mode_.Data());
+
+	return label;
+}
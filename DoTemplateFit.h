@@ -0,0 +1,74 @@
+/*
+ * DoTemplateFit.h
+ * QCD estimate from a binned maximum likelihood fit of the data jet
+ * multiplicity in the signal region D. The QCD template is the data
+ * minus MC in the non-isolated control region C, the MC backgrounds are
+ * taken from the same DataSamples as DoABCD. The QCD normalisation is
+ * free, ttbar and W+jets float within their normalisation uncertainties.
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef DOTEMPLATEFIT_H_
+#define DOTEMPLATEFIT_H_
+
+#include <vector>
+#include "TString.h"
+#include "DataSample.h"
+#include "SampleSet.h"
+
+class DoTemplateFit {
+
+private:
+	// Owns the systematic variations, and the sample set unless it was
+	// passed in
+	SampleSet* sample_set_;
+	bool owns_sample_set_;
+	DoTemplateFit* syst_up_;
+	DoTemplateFit* syst_down_;
+
+	TString mode_;
+	bool doInclusive_;
+	int jet_bin_;
+	int sysMode_;
+
+	// Fit result, filled on first use
+	bool is_fitted_;
+	std::vector<double> qcd_template_;
+	std::vector<double> qcd_template_error_;
+	double qcd_scale_;
+	double qcd_scale_error_;
+
+	void fit(void);
+	std::vector<double> getRegionBins(DataSample* sample, int region);
+	std::vector<double> getRegionBinErrors(DataSample* sample, int region);
+	int getLastJetBin(void) const;
+
+	DoTemplateFit(const DoTemplateFit&);
+	DoTemplateFit& operator=(const DoTemplateFit&);
+
+public:
+	DoTemplateFit(TString mode = "tag", bool doInclusive = false, int jet_bin =
+			3, int sysMode = 1);
+	// Reads from already loaded samples, which have to outlive the driver
+	DoTemplateFit(TString mode, bool doInclusive, int jet_bin, int sysMode,
+			const SampleCollection& samples);
+	// Shares the samples of a set, which has to outlive the driver
+	DoTemplateFit(TString mode, bool doInclusive, int jet_bin, int sysMode,
+			SampleSet& samples);
+	virtual ~DoTemplateFit();
+
+	void printNdEstimateTable(void);
+
+	// Fitted scale of the QCD template
+	double getQcdScale(void);
+	double getQcdScaleError(void);
+
+	double getNdEstimate(void);
+	double getNdError(void);
+	double getNdSystError(void);
+
+	TString getLabel(void);
+};
+
+#endif /* DOTEMPLATEFIT_H_ */
@@ -0,0 +1,224 @@
+/*
+ * EstimateCovariance.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include "EstimateCovariance.h"
+#include "SampleSet.h"
+#include "RegionYieldTable.h"
+#include "ABCDReader.h"
+#include "AbcdBase.h"
+#include "RunTrace.h"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <math.h>
+
+namespace {
+
+// Powers of A to C in the estimate, dD / D = sum power * dX / X
+const int kNRegions = 3;
+const double kRegionPowers[kNRegions] = { -1., 1., 1. };
+
+} // End anonymous namespace
+
+EstimateCovariance::EstimateCovariance(SampleSet& samples) {
+	const std::vector<std::string>& names = samples.GetSampleNames();
+	const SampleCollection& collection = samples.GetSamples();
+	for (unsigned int sample_idx = 0; sample_idx != names.size();
+			sample_idx++) {
+		TString sample_name = names.at(sample_idx);
+		sample_names_.push_back(sample_name);
+		is_data_.push_back(SampleSet::IsData(sample_name));
+		tables_.push_back(
+				collection.find(sample_name)->second->GetYieldTable());
+	}
+
+	const char* modes[] = { "pretag", "tag" };
+	for (int mode_idx = 0; mode_idx != 2; mode_idx++) {
+		for (int jet_bin = 1; jet_bin != 5; jet_bin++) {
+			this->AddConfig(modes[mode_idx], jet_bin, false);
+		}
+		this->AddConfig(modes[mode_idx], 3, true);
+		this->AddConfig(modes[mode_idx], 4, true);
+	}
+}
+
+EstimateCovariance::~EstimateCovariance() {
+}
+
+void EstimateCovariance::ClearConfigs() {
+	configs_.clear();
+}
+
+void EstimateCovariance::AddConfig(TString mode, int jet_bin,
+		bool is_inclusive) {
+	QcdEstimator::Config config;
+	config.mode = mode;
+	config.jet_bin = jet_bin;
+	config.is_inclusive = is_inclusive;
+	configs_.push_back(config);
+}
+
+TString EstimateCovariance::GetLabel(unsigned int config_index) const {
+	const QcdEstimator::Config& config = configs_.at(config_index);
+	// 3 jet inc (pretag)
+	return TString::Format("%s(%s)",
+			SampleSet::GetJetLabel(config.jet_bin, config.is_inclusive).Data(),
+			config.mode.Data());
+}
+
+// D = B * C / A of data minus the MC scaled for sys_mode
+double EstimateCovariance::GetShiftedEstimate(int mode_index, int first_bin,
+		int last_bin, int sys_mode) const {
+	double corrected[kNRegions];
+	for (int region_idx = 0; region_idx != kNRegions; region_idx++) {
+		corrected[region_idx] = 0.;
+		for (unsigned int sample_idx = 0; sample_idx != tables_.size();
+				sample_idx++) {
+			double factor =
+					is_data_[sample_idx] ?
+							1. :
+							-ABCDReader::GetSampleSystFactor(
+									sample_names_[sample_idx], sys_mode);
+			corrected[region_idx] += factor
+					* tables_[sample_idx]->GetYield(mode_index,
+							AbcdBase::A + region_idx, first_bin, last_bin);
+		}
+	}
+	return corrected[1] * corrected[2] / corrected[0];
+}
+
+void EstimateCovariance::Run() {
+	TraceSpan span("estimate", "EstimateCovariance::Run");
+	unsigned int n_configs = configs_.size();
+	unsigned int n_samples = tables_.size();
+	const RegionYieldTable* binning = tables_.at(0);
+	int tag_index = binning->GetModeIndex("tag");
+
+	std::vector<int> mode_indices(n_configs);
+	std::vector<int> first_bins(n_configs);
+	std::vector<int> last_bins(n_configs);
+	// dD/dyield, [config][sample][region]
+	std::vector<double> gradients(n_configs * n_samples * kNRegions);
+	estimates_.assign(n_configs, 0.);
+	syst_shifts_.assign(n_configs, 0.);
+
+	for (unsigned int config_idx = 0; config_idx != n_configs; config_idx++) {
+		const QcdEstimator::Config& config = configs_[config_idx];
+		mode_indices[config_idx] = binning->GetModeIndex(config.mode);
+		if (mode_indices[config_idx] < 0) {
+			std::cout << "EstimateCovariance::Run - Unknown mode "
+					<< config.mode << std::endl;
+			exit(-1);
+		}
+		binning->GetBinRange(config.jet_bin, config.is_inclusive,
+				first_bins[config_idx], last_bins[config_idx]);
+
+		double corrected[kNRegions];
+		for (int region_idx = 0; region_idx != kNRegions; region_idx++) {
+			corrected[region_idx] = 0.;
+			for (unsigned int sample_idx = 0; sample_idx != n_samples;
+					sample_idx++) {
+				double sign = is_data_[sample_idx] ? 1. : -1.;
+				corrected[region_idx] += sign
+						* tables_[sample_idx]->GetYield(
+								mode_indices[config_idx],
+								AbcdBase::A + region_idx,
+								first_bins[config_idx], last_bins[config_idx]);
+			}
+		}
+		double estimate = corrected[1] * corrected[2] / corrected[0];
+		estimates_[config_idx] = estimate;
+
+		for (unsigned int sample_idx = 0; sample_idx != n_samples;
+				sample_idx++) {
+			double sign = is_data_[sample_idx] ? 1. : -1.;
+			for (int region_idx = 0; region_idx != kNRegions; region_idx++) {
+				gradients[(config_idx * n_samples + sample_idx) * kNRegions
+						+ region_idx] = sign * estimate
+						* kRegionPowers[region_idx] / corrected[region_idx];
+			}
+		}
+
+		// The larger shift, signed along the up variation
+		double up_shift = this->GetShiftedEstimate(mode_indices[config_idx],
+				first_bins[config_idx], last_bins[config_idx], 2) - estimate;
+		double down_shift = this->GetShiftedEstimate(mode_indices[config_idx],
+				first_bins[config_idx], last_bins[config_idx], 0) - estimate;
+		syst_shifts_[config_idx] =
+				(fabs(up_shift) >= fabs(down_shift)) ? up_shift : -down_shift;
+	}
+
+	stat_covariance_.assign(n_configs * n_configs, 0.);
+	syst_covariance_.assign(n_configs * n_configs, 0.);
+	for (unsigned int row = 0; row != n_configs; row++) {
+		for (unsigned int column = row; column != n_configs; column++) {
+			int first_bin = std::max(first_bins[row], first_bins[column]);
+			int last_bin = std::min(last_bins[row], last_bins[column]);
+			// Tag and pretag only share the tag events
+			int mode_index =
+					(mode_indices[row] == mode_indices[column]) ?
+							mode_indices[row] : tag_index;
+
+			double covariance = 0.;
+			if (first_bin <= last_bin) {
+				for (unsigned int sample_idx = 0; sample_idx != n_samples;
+						sample_idx++) {
+					for (int region_idx = 0; region_idx != kNRegions;
+							region_idx++) {
+						double sumw2 = tables_[sample_idx]->GetSumw2(mode_index,
+								AbcdBase::A + region_idx, first_bin, last_bin);
+						covariance += gradients[(row * n_samples + sample_idx)
+								* kNRegions + region_idx]
+								* gradients[(column * n_samples + sample_idx)
+										* kNRegions + region_idx] * sumw2;
+					}
+				}
+			}
+			stat_covariance_[row * n_configs + column] = covariance;
+			stat_covariance_[column * n_configs + row] = covariance;
+
+			double syst = syst_shifts_[row] * syst_shifts_[column];
+			syst_covariance_[row * n_configs + column] = syst;
+			syst_covariance_[column * n_configs + row] = syst;
+		}
+	}
+}
+
+double EstimateCovariance::GetCorrelation(unsigned int row,
+		unsigned int column) const {
+	return this->GetCovariance(row, column)
+			/ sqrt(this->GetCovariance(row, row)
+					* this->GetCovariance(column, column));
+}
+
+void EstimateCovariance::PrintTable() const {
+	TraceSpan span("output", "EstimateCovariance::PrintTable");
+	unsigned int n_configs = configs_.size();
+
+	std::cout << std::setprecision(1) << std::fixed;
+	for (unsigned int config_idx = 0; config_idx != n_configs; config_idx++) {
+		std::cout << "| " << this->GetLabel(config_idx) << " | "
+				<< estimates_[config_idx] << AbcdBase::pm
+				<< sqrt(this->GetStatCovariance(config_idx, config_idx))
+				<< " (stat)" << AbcdBase::pm
+				<< sqrt(this->GetSystCovariance(config_idx, config_idx))
+				<< " (syst) |" << std::endl;
+	}
+
+	std::cout << std::setprecision(2);
+	std::cout << "| *Correlation* |";
+	for (unsigned int column = 0; column != n_configs; column++) {
+		std::cout << " " << this->GetLabel(column) << " |";
+	}
+	std::cout << std::endl;
+	for (unsigned int row = 0; row != n_configs; row++) {
+		std::cout << "| " << this->GetLabel(row) << " |";
+		for (unsigned int column = 0; column != n_configs; column++) {
+			std::cout << " " << this->GetCorrelation(row, column) << " |";
+		}
+		std::cout << std::endl;
+	}
+}
@@ -0,0 +1,94 @@
+/*
+ * EstimateCovariance.h
+ * ABCD estimates of several jet selections and modes with their full
+ * covariance, from the yield tables of one SampleSet in a single pass.
+ *
+ * Statistical part: D = B * C / A is linearised in the yields of every
+ * sample, region and jet bin, which are independent. Two selections
+ * share the bins where their jet ranges overlap, e.g. 3 inc with 3 and
+ * 4 jets. Tag events are a subset of pretag ones, so a tag and a pretag
+ * selection share the tag part of the overlap only:
+ *   cov(c, d) = sum_s,r g(c,s,r) g(d,s,r) sumw2(s, r, overlap)
+ * with g = dD/dyield = +-D / X for B, C and A, X the corrected yield.
+ *
+ * Systematic part: the MC normalisations are shifted together, as in
+ * DoABCD::getNdSystError, which is one nuisance shared by every
+ * selection. With delta the larger shift, signed along the up variation,
+ *   cov(c, d) = delta(c) delta(d)
+ * so the diagonal is the DoABCD syst error squared.
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef ESTIMATECOVARIANCE_H_
+#define ESTIMATECOVARIANCE_H_
+
+#include <vector>
+#include "TString.h"
+#include "QcdEstimator.h"
+
+class SampleSet;
+class RegionYieldTable;
+
+class EstimateCovariance {
+
+private:
+	// Yield tables of every sample, owned by the samples
+	std::vector<const RegionYieldTable*> tables_;
+	std::vector<TString> sample_names_;
+	std::vector<bool> is_data_;
+
+	std::vector<QcdEstimator::Config> configs_;
+	std::vector<double> estimates_;
+	std::vector<double> syst_shifts_;
+	// [config][config]
+	std::vector<double> stat_covariance_;
+	std::vector<double> syst_covariance_;
+
+	double GetShiftedEstimate(int mode_index, int first_bin, int last_bin,
+			int sys_mode) const;
+
+	EstimateCovariance(const EstimateCovariance&);
+	EstimateCovariance& operator=(const EstimateCovariance&);
+
+public:
+	// Starts with pretag and tag, jet bins 1 to 4, 3 inc and 4 inc. The
+	// set has to outlive this object.
+	EstimateCovariance(SampleSet& samples);
+	virtual ~EstimateCovariance();
+
+	void ClearConfigs(void);
+	void AddConfig(TString mode, int jet_bin, bool is_inclusive);
+
+	// Estimates and both covariance matrices of all configurations
+	void Run(void);
+
+	unsigned int GetNConfigs(void) const {
+		return configs_.size();
+	}
+	const QcdEstimator::Config& GetConfig(unsigned int config_index) const {
+		return configs_.at(config_index);
+	}
+	TString GetLabel(unsigned int config_index) const;
+
+	double GetEstimate(unsigned int config_index) const {
+		return estimates_.at(config_index);
+	}
+	double GetStatCovariance(unsigned int row, unsigned int column) const {
+		return stat_covariance_.at(row * configs_.size() + column);
+	}
+	double GetSystCovariance(unsigned int row, unsigned int column) const {
+		return syst_covariance_.at(row * configs_.size() + column);
+	}
+	double GetCovariance(unsigned int row, unsigned int column) const {
+		return this->GetStatCovariance(row, column)
+				+ this->GetSystCovariance(row, column);
+	}
+	// Of the total covariance
+	double GetCorrelation(unsigned int row, unsigned int column) const;
+
+	// Estimates with their errors, then the correlation matrix
+	void PrintTable(void) const;
+};
+
+#endif /* ESTIMATECOVARIANCE_H_ */
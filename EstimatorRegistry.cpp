@@ -0,0 +1,179 @@
+/*
+ * EstimatorRegistry.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include "EstimatorRegistry.h"
+#include "SampleSet.h"
+#include "DoABCD.h"
+#include "DoRSMT.h"
+#include "DoTemplateFit.h"
+#include "AbcdBase.h"
+#include "ParallelFor.h"
+#include "RunTrace.h"
+#include <iostream>
+#include <iomanip>
+
+namespace {
+
+// D = B * C / A in the mode of the configuration
+class AbcdEstimator: public QcdEstimator {
+public:
+	AbcdEstimator(SampleSet& samples) :
+			QcdEstimator(samples) {
+	}
+	TString GetName(void) const {
+		return "ABCD";
+	}
+	Result Evaluate(const Config& config) const {
+		DoABCD driver(config.mode, config.is_inclusive, config.jet_bin, 1,
+				*sample_set_);
+		Result result;
+		result.estimate = driver.getNdEstimate();
+		result.stat_error = driver.getNdError();
+		result.syst_error = driver.getNdSystError();
+		return result;
+	}
+};
+
+// Pretag ABCD times the weighted R_smt, the pretag mode is the pretag
+// ABCD estimate alone
+class RsmtEstimator: public QcdEstimator {
+public:
+	RsmtEstimator(SampleSet& samples) :
+			QcdEstimator(samples) {
+	}
+	TString GetName(void) const {
+		return "RSMT";
+	}
+	Result Evaluate(const Config& config) const {
+		DoRSMT driver(config.jet_bin, config.is_inclusive, 1, *sample_set_);
+		Result result;
+		if (config.mode.Contains("pretag")) {
+			result.estimate = driver.GetPretagEstimate();
+			result.stat_error = driver.GetPretagEstimateStatError();
+			result.syst_error = driver.GetPretagEstimateSystError();
+		} else {
+			result.estimate = driver.GetTagEstimate();
+			result.stat_error = driver.GetTagEstimateStatError();
+			result.syst_error = driver.GetTagEstimateSystError();
+		}
+		return result;
+	}
+};
+
+// Fitted QCD template in the jet multiplicity of region D
+class TemplateFitEstimator: public QcdEstimator {
+public:
+	TemplateFitEstimator(SampleSet& samples) :
+			QcdEstimator(samples) {
+	}
+	TString GetName(void) const {
+		return "TemplateFit";
+	}
+	Result Evaluate(const Config& config) const {
+		DoTemplateFit driver(config.mode, config.is_inclusive, config.jet_bin,
+				1, *sample_set_);
+		Result result;
+		result.estimate = driver.getNdEstimate();
+		result.stat_error = driver.getNdError();
+		result.syst_error = driver.getNdSystError();
+		return result;
+	}
+};
+
+QcdEstimator* CreateAbcd(SampleSet& samples) {
+	return new AbcdEstimator(samples);
+}
+
+QcdEstimator* CreateRsmt(SampleSet& samples) {
+	return new RsmtEstimator(samples);
+}
+
+QcdEstimator* CreateTemplateFit(SampleSet& samples) {
+	return new TemplateFitEstimator(samples);
+}
+
+} // End anonymous namespace
+
+EstimatorRegistry::FactoryMap& EstimatorRegistry::GetFactories() {
+	static FactoryMap factories;
+	if (factories.empty()) {
+		factories["ABCD"] = CreateAbcd;
+		factories["RSMT"] = CreateRsmt;
+		factories["TemplateFit"] = CreateTemplateFit;
+	}
+	return factories;
+}
+
+void EstimatorRegistry::Register(TString name, Factory factory) {
+	GetFactories()[name] = factory;
+}
+
+std::vector<TString> EstimatorRegistry::GetNames() {
+	std::vector<TString> names;
+	FactoryMap& factories = GetFactories();
+	FactoryMap::iterator iter = factories.begin();
+	FactoryMap::iterator iter_end = factories.end();
+	for (; iter != iter_end; iter++) {
+		names.push_back(iter->first);
+	}
+	return names;
+}
+
+QcdEstimator* EstimatorRegistry::Create(TString name, SampleSet& samples) {
+	FactoryMap& factories = GetFactories();
+	FactoryMap::iterator found = factories.find(name);
+	if (found == factories.end()) {
+		std::cout << "EstimatorRegistry::Create - Unknown method " << name
+				<< std::endl;
+		return 0;
+	}
+	return found->second(samples);
+}
+
+// The estimators are built up front, each entry only reads its own
+// estimator and the set
+std::vector<EstimatorRegistry::Entry> EstimatorRegistry::Run(
+		SampleSet& samples, const std::vector<QcdEstimator::Config>& configs) {
+	TraceSpan span("estimate", "EstimatorRegistry::Run");
+	std::vector<TString> names = GetNames();
+	std::vector<QcdEstimator*> estimators;
+	for (unsigned int name_idx = 0; name_idx != names.size(); name_idx++) {
+		estimators.push_back(Create(names.at(name_idx), samples));
+	}
+
+	std::vector<Entry> entries(names.size() * configs.size());
+	for (unsigned int entry_idx = 0; entry_idx != entries.size();
+			entry_idx++) {
+		entries[entry_idx].method = names.at(entry_idx / configs.size());
+		entries[entry_idx].config = configs.at(entry_idx % configs.size());
+	}
+
+	ParallelFor(entries.size(), [&](unsigned int entry_idx) {
+		Entry& entry = entries[entry_idx];
+		entry.result = estimators[entry_idx / configs.size()]->Evaluate(
+				entry.config);
+	});
+
+	for (unsigned int name_idx = 0; name_idx != estimators.size();
+			name_idx++) {
+		delete estimators.at(name_idx);
+	}
+	return entries;
+}
+
+void EstimatorRegistry::PrintTable(const std::vector<Entry>& entries) {
+	std::cout << std::setprecision(1) << std::fixed;
+	for (unsigned int entry_idx = 0; entry_idx != entries.size();
+			entry_idx++) {
+		const Entry& entry = entries.at(entry_idx);
+		std::cout << "| " << entry.method << " | "
+				<< SampleSet::GetJetLabel(entry.config.jet_bin,
+						entry.config.is_inclusive) << "(" << entry.config.mode
+				<< ") | " << entry.result.estimate << AbcdBase::pm
+				<< entry.result.stat_error << " (stat)" << AbcdBase::pm
+				<< entry.result.syst_error << " (syst) |" << std::endl;
+	}
+}
@@ -0,0 +1,55 @@
+/*
+ * EstimatorRegistry.h
+ * QCD estimation methods by name, each a factory of QcdEstimator objects
+ * on a SampleSet. ABCD, RSMT and TemplateFit are registered from the
+ * start. Run evaluates every registered method on every configuration
+ * in parallel on one sample set, so the samples are read once for the
+ * whole table. GridABCD is not registered: its larger layouts read
+ * regions the standard inputs do not have.
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef ESTIMATORREGISTRY_H_
+#define ESTIMATORREGISTRY_H_
+
+#include <vector>
+#include <map>
+#include "TString.h"
+#include "QcdEstimator.h"
+
+class SampleSet;
+
+class EstimatorRegistry {
+
+public:
+	typedef QcdEstimator* (*Factory)(SampleSet& samples);
+
+	// One method on one configuration
+	struct Entry {
+		TString method;
+		QcdEstimator::Config config;
+		QcdEstimator::Result result;
+	};
+
+private:
+	typedef std::map<TString, Factory> FactoryMap;
+	static FactoryMap& GetFactories(void);
+
+	EstimatorRegistry();
+
+public:
+	// Replaces a method of the same name. Register methods before Run.
+	static void Register(TString name, Factory factory);
+	static std::vector<TString> GetNames(void);
+	// Owned by the caller, 0 for an unknown method
+	static QcdEstimator* Create(TString name, SampleSet& samples);
+
+	// Every registered method on every configuration, method varies
+	// slowest
+	static std::vector<Entry> Run(SampleSet& samples,
+			const std::vector<QcdEstimator::Config>& configs);
+	static void PrintTable(const std::vector<Entry>& entries);
+};
+
+#endif /* ESTIMATORREGISTRY_H_ */
@@ -0,0 +1,408 @@
+/*
+ * EventLoop.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include "EventLoop.h"
+#include "ParallelFor.h"
+#include "SkimStore.h"
+#include "RunTrace.h"
+#include "TROOT.h"
+#include "TFile.h"
+#include "TTree.h"
+#include <iostream>
+#include <glob.h>
+#include <algorithm>
+#include <math.h>
+
+namespace {
+
+const char* kModes[] = { "pretag", "tag" };
+const char* kRegions[] = { "A", "B", "C", "D" };
+const int kNModes = 2;
+const int kNRegions = 4;
+
+// Jet multiplicity 0 to 19 in bins 1 to 20, as in the production
+const int kNJetBins = 20;
+const int kNBins = kNJetBins + 2;
+
+// Small enough to keep every core busy on a handful of files
+const Long64_t kEntriesPerRange = 500000;
+
+} // End anonymous namespace
+
+EventLoop::EventLoop(TString tree_name, TString channel) :
+		tree_name_(tree_name), channel_(channel), met_branch_("met"), iso_branch_(
+				"el_etcone20"), n_jet_branch_("jet_n"), n_tag_branch_(
+				"jet_n_btag"), weight_branch_(""), met_cut_(25.), iso_cut_(6.) {
+	variations_.push_back("");
+	variation_branches_.push_back("");
+}
+
+EventLoop::~EventLoop() {
+	this->ClearHistos();
+}
+
+void EventLoop::ClearHistos() {
+	std::map<TString, TH1D*>::iterator iter = histos_.begin();
+	for (; iter != histos_.end(); iter++) {
+		delete iter->second;
+	}
+	histos_.clear();
+}
+
+void EventLoop::AddInputFile(TString file_path) {
+	input_files_.push_back(file_path);
+}
+
+void EventLoop::AddInputFiles(TString pattern) {
+	glob_t matches;
+	int status = glob(pattern.Data(), 0, 0, &matches);
+
+	if (status != 0 || matches.gl_pathc == 0) {
+		std::cout << "EventLoop::AddInputFiles - No files match " << pattern
+				<< std::endl;
+		globfree(&matches);
+		exit(-1);
+	}
+
+	for (size_t match_idx = 0; match_idx != matches.gl_pathc; match_idx++) {
+		this->AddInputFile(matches.gl_pathv[match_idx]);
+	}
+	globfree(&matches);
+}
+
+void EventLoop::AddWeightVariation(TString variation, TString weight_branch) {
+	variations_.push_back(variation);
+	variation_branches_.push_back(weight_branch);
+}
+
+unsigned int EventLoop::GetIndex(unsigned int variation, int mode, int region,
+		int bin) const {
+	return ((variation * kNModes + mode) * kNRegions + region) * kNBins + bin;
+}
+
+TString EventLoop::GetHistoName(TString mode, int region,
+		TString variation) const {
+	TString name = TString::Format("h_njet_%s_%s_%s", mode.Data(),
+			kRegions[region], channel_.Data());
+	if (variation.Length() != 0)
+		name += "_" + variation;
+	return name;
+}
+
+// Counts the entries of every file, then cuts them in ranges
+std::vector<EventLoop::EntryRange> EventLoop::GetEntryRanges() const {
+	std::vector<Long64_t> n_entries(input_files_.size(), 0);
+	ParallelFor(input_files_.size(), [&](unsigned int file_idx) {
+		TFile* file = TFile::Open(input_files_.at(file_idx));
+		if (file == 0 || file->IsZombie()) {
+			std::cout << "EventLoop::GetEntryRanges - File NOT found: "
+					<< input_files_.at(file_idx) << std::endl;
+			exit(-1);
+		}
+		TTree* tree = (TTree*) file->Get(tree_name_);
+		if (tree == 0) {
+			std::cout << "EventLoop::GetEntryRanges - " << tree_name_
+					<< " NOT found in " << input_files_.at(file_idx) << std::endl;
+			exit(-1);
+		}
+		n_entries[file_idx] = tree->GetEntries();
+		file->Close();
+		delete file;
+	});
+
+	std::vector<EntryRange> ranges;
+	for (unsigned int file_idx = 0; file_idx != input_files_.size();
+			file_idx++) {
+		for (Long64_t first = 0; first < n_entries[file_idx];
+				first += kEntriesPerRange) {
+			EntryRange range;
+			range.file_index = file_idx;
+			range.first_entry = first;
+			range.last_entry = std::min(first + kEntriesPerRange,
+					n_entries[file_idx]);
+			ranges.push_back(range);
+		}
+	}
+	return ranges;
+}
+
+// Reads only the selection branches of one range into columns, one
+// weight column per variation
+void EventLoop::ReadRange(const EntryRange& range, SkimColumns& columns) const {
+	TString file_path = input_files_.at(range.file_index);
+	TraceSpan span("io", "ReadRange", file_path.Data());
+	TFile* file = TFile::Open(file_path);
+	TTree* tree = (TTree*) file->Get(tree_name_);
+
+	float met = 0.;
+	float iso = 0.;
+	int n_jet = 0;
+	int n_tag = 0;
+	float weight = 1.;
+	std::vector<float> variation_weights(variations_.size(), 1.);
+
+	tree->SetBranchStatus("*", false);
+	const char* branches[] = { met_branch_.Data(), iso_branch_.Data(),
+			n_jet_branch_.Data(), n_tag_branch_.Data() };
+	void* addresses[] = { &met, &iso, &n_jet, &n_tag };
+	for (int branch_idx = 0; branch_idx != 4; branch_idx++) {
+		tree->SetBranchStatus(branches[branch_idx], true);
+		tree->SetBranchAddress(branches[branch_idx], addresses[branch_idx]);
+	}
+	if (weight_branch_.Length() != 0) {
+		tree->SetBranchStatus(weight_branch_, true);
+		tree->SetBranchAddress(weight_branch_, &weight);
+	}
+	for (unsigned int var_idx = 1; var_idx != variations_.size(); var_idx++) {
+		tree->SetBranchStatus(variation_branches_[var_idx], true);
+		tree->SetBranchAddress(variation_branches_[var_idx],
+				&variation_weights[var_idx]);
+	}
+
+	unsigned int n_events = range.last_entry - range.first_entry;
+	columns.met.resize(n_events);
+	columns.iso.resize(n_events);
+	columns.weight.resize(n_events);
+	columns.variation_weights.assign(variations_.size() - 1,
+			std::vector<float>(n_events));
+	columns.n_jet.resize(n_events);
+	columns.n_tag.resize(n_events);
+
+	for (unsigned int event = 0; event != n_events; event++) {
+		tree->GetEntry(range.first_entry + event);
+		columns.met[event] = met;
+		columns.iso[event] = iso;
+		columns.weight[event] = weight;
+		for (unsigned int var_idx = 1; var_idx != variations_.size();
+				var_idx++) {
+			columns.variation_weights[var_idx - 1][event] =
+					variation_weights[var_idx];
+		}
+		columns.n_jet[event] = std::min(std::max(n_jet, 0), 255);
+		columns.n_tag[event] = std::min(std::max(n_tag, 0), 255);
+	}
+
+	file->Close();
+	delete file;
+}
+
+void EventLoop::InitAccumulator(Accumulator& accumulator) const {
+	accumulator.contents.assign(
+			variations_.size() * kNModes * kNRegions * kNBins, 0.);
+	accumulator.sumw2.assign(accumulator.contents.size(), 0.);
+}
+
+// Events first_event to last_event - 1 of the columns, weights holds the
+// nominal weight column first and then one per variation
+void EventLoop::FillEvents(uint64_t first_event, uint64_t last_event,
+		const float* met, const float* iso, const uint8_t* n_jet,
+		const uint8_t* n_tag, const std::vector<const float*>& weights,
+		Accumulator& accumulator) const {
+	for (uint64_t event = first_event; event != last_event; event++) {
+		bool low_met = met[event] < met_cut_;
+		bool isolated = iso[event] < iso_cut_;
+		int region = (low_met ? 0 : 2) + (isolated ? 1 : 0);
+		int bin = std::min(n_jet[event] + 1, kNBins - 1);
+		int n_modes = (n_tag[event] > 0) ? 2 : 1;
+
+		for (unsigned int var_idx = 0; var_idx != weights.size(); var_idx++) {
+			double event_weight = weights[var_idx][event];
+			for (int mode = 0; mode != n_modes; mode++) {
+				unsigned int index = this->GetIndex(var_idx, mode, region, bin);
+				accumulator.contents[index] += event_weight;
+				accumulator.sumw2[index] += event_weight * event_weight;
+			}
+		}
+	}
+}
+
+// Sums the accumulators in order, independent of which thread filled
+// what, and books the histograms
+void EventLoop::BuildHistos(const std::vector<Accumulator>& accumulators) {
+	this->ClearHistos();
+
+	Accumulator total;
+	this->InitAccumulator(total);
+	for (unsigned int range_idx = 0; range_idx != accumulators.size();
+			range_idx++) {
+		for (unsigned int index = 0; index != total.contents.size(); index++) {
+			total.contents[index] += accumulators[range_idx].contents[index];
+			total.sumw2[index] += accumulators[range_idx].sumw2[index];
+		}
+	}
+
+	for (unsigned int var_idx = 0; var_idx != variations_.size(); var_idx++) {
+		for (int mode = 0; mode != kNModes; mode++) {
+			for (int region = 0; region != kNRegions; region++) {
+				TString name = this->GetHistoName(kModes[mode], region,
+						variations_[var_idx]);
+				TH1D* histo = new TH1D(name, name, kNJetBins, -0.5,
+						kNJetBins - 0.5);
+				histo->SetDirectory(0);
+				histo->Sumw2();
+				for (int bin = 0; bin != kNBins; bin++) {
+					unsigned int index = this->GetIndex(var_idx, mode, region,
+							bin);
+					histo->SetBinContent(bin, total.contents[index]);
+					histo->SetBinError(bin, sqrt(total.sumw2[index]));
+				}
+				histos_[name] = histo;
+			}
+		}
+	}
+}
+
+// Each range is read into columns and filled from there, so the ntuples
+// and the skims go through the same selection
+void EventLoop::Run() {
+	TraceSpan span("load", "EventLoop::Run", tree_name_.Data());
+	ROOT::EnableThreadSafety();
+
+	std::vector<EntryRange> ranges = this->GetEntryRanges();
+	std::vector<Accumulator> accumulators(ranges.size());
+	ParallelFor(ranges.size(), [&](unsigned int range_idx) {
+		SkimColumns columns;
+		this->ReadRange(ranges[range_idx], columns);
+
+		std::vector<const float*> weights(1, columns.weight.data());
+		for (unsigned int var_idx = 0;
+				var_idx != columns.variation_weights.size(); var_idx++) {
+			weights.push_back(columns.variation_weights[var_idx].data());
+		}
+		this->InitAccumulator(accumulators[range_idx]);
+		this->FillEvents(0, columns.GetNEvents(), columns.met.data(),
+				columns.iso.data(), columns.n_jet.data(), columns.n_tag.data(),
+				weights, accumulators[range_idx]);
+	});
+
+	this->BuildHistos(accumulators);
+}
+
+bool EventLoop::Skim(TString skim_path) {
+	TraceSpan span("output", "EventLoop::Skim", skim_path.Data());
+	ROOT::EnableThreadSafety();
+
+	// The entry counts place every range in the columns, so each range
+	// is written as soon as it is read and only the ranges in flight
+	// are held in memory
+	std::vector<EntryRange> ranges = this->GetEntryRanges();
+	std::vector<uint64_t> first_events(ranges.size());
+	uint64_t n_events = 0;
+	for (unsigned int range_idx = 0; range_idx != ranges.size();
+			range_idx++) {
+		first_events[range_idx] = n_events;
+		n_events += ranges[range_idx].last_entry
+				- ranges[range_idx].first_entry;
+	}
+
+	std::vector<TString> variation_names(variations_.begin() + 1,
+			variations_.end());
+	SkimWriter writer(skim_path, n_events, variation_names);
+	if (!writer.IsOpen())
+		return false;
+
+	std::vector<char> is_written(ranges.size(), 0);
+	ParallelFor(ranges.size(), [&](unsigned int range_idx) {
+		SkimColumns columns;
+		this->ReadRange(ranges[range_idx], columns);
+		is_written[range_idx] = writer.WriteRange(first_events[range_idx],
+				columns);
+	});
+
+	bool is_ok = writer.Close();
+	for (unsigned int range_idx = 0; range_idx != ranges.size();
+			range_idx++) {
+		is_ok &= (is_written[range_idx] != 0);
+	}
+	return is_ok;
+}
+
+// Every weight variation asked for has to be in the skim
+void EventLoop::RunSkim(TString skim_path) {
+	TraceSpan span("load", "EventLoop::RunSkim", skim_path.Data());
+	SkimStore skim(skim_path);
+	if (!skim.IsOpen()) {
+		std::cout << "EventLoop::RunSkim - Cannot read " << skim_path
+				<< std::endl;
+		exit(-1);
+	}
+
+	std::vector<const float*> weights(1, skim.GetWeight());
+	for (unsigned int var_idx = 1; var_idx != variations_.size(); var_idx++) {
+		int skim_idx = skim.FindVariation(variations_[var_idx]);
+		if (skim_idx < 0) {
+			std::cout << "EventLoop::RunSkim - Variation "
+					<< variations_[var_idx] << " NOT in " << skim_path
+					<< std::endl;
+			exit(-1);
+		}
+		weights.push_back(skim.GetVariationWeight(skim_idx));
+	}
+
+	uint64_t n_events = skim.GetNEvents();
+	uint64_t range_size = kEntriesPerRange;
+	unsigned int n_ranges = (n_events + range_size - 1) / range_size;
+	std::vector<Accumulator> accumulators(n_ranges);
+	ParallelFor(n_ranges, [&](unsigned int range_idx) {
+		uint64_t first_event = range_idx * range_size;
+		uint64_t last_event = std::min(first_event + range_size, n_events);
+		this->InitAccumulator(accumulators[range_idx]);
+		this->FillEvents(first_event, last_event, skim.GetMet(), skim.GetIso(),
+				skim.GetNJet(), skim.GetNTag(), weights,
+				accumulators[range_idx]);
+	});
+
+	this->BuildHistos(accumulators);
+}
+
+// Returns 0 before Run or for an unknown variation
+TH1D* EventLoop::GetHisto(TString mode, int region, TString variation) const {
+	std::map<TString, TH1D*>::const_iterator found = histos_.find(
+			this->GetHistoName(mode, region, variation));
+	return (found != histos_.end()) ? found->second : 0;
+}
+
+void EventLoop::Fill(DataSample* sample, TString variation) const {
+	if (sample->GetNRegions() != (unsigned int) kNRegions) {
+		std::cout << "EventLoop::Fill - " << sample->GetSampleName()
+				<< " needs regions A to D" << std::endl;
+		exit(-1);
+	}
+
+	std::map<TString, TH1*> histos;
+	for (int mode = 0; mode != kNModes; mode++) {
+		for (int region = 0; region != kNRegions; region++) {
+			TH1D* histo = this->GetHisto(kModes[mode], region, variation);
+			if (histo == 0) {
+				std::cout << "EventLoop::Fill - No histograms for variation '"
+						<< variation << "', call Run first" << std::endl;
+				exit(-1);
+			}
+			histos[sample->GetRegionHistoName(kModes[mode], region)] = histo;
+		}
+	}
+	sample->SetRegionHistos(histos);
+}
+
+bool EventLoop::Write(TString output_path) const {
+	TFile* output = TFile::Open(output_path, "RECREATE");
+	if (output == 0 || output->IsZombie()) {
+		std::cout << "EventLoop::Write - Cannot write " << output_path
+				<< std::endl;
+		delete output;
+		return false;
+	}
+
+	// Written into the current directory, the histograms stay ours
+	output->cd();
+	std::map<TString, TH1D*>::const_iterator iter = histos_.begin();
+	for (; iter != histos_.end(); iter++) {
+		iter->second->Write();
+	}
+	output->Close();
+	delete output;
+	return true;
+}
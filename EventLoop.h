@@ -0,0 +1,140 @@
+/*
+ * EventLoop.h
+ * Fills the region histograms h_njet_<mode>_<region>_<channel> straight
+ * from flat D3PD-derived ntuples, so that a moved cut does not need a new
+ * histogramming production. One event loop fills pretag and tag, regions
+ * A to D and every weight variation at once:
+ *   A: MET < met cut, etcone20 >= iso cut     B: MET < met cut, isolated
+ *   C: MET >= met cut, etcone20 >= iso cut    D: MET >= met cut, isolated
+ * tag events have at least one b-tagged jet and are a subset of pretag.
+ *
+ * The entries are split in ranges filled in parallel, each into its own
+ * accumulator, and summed in range order so the result does not depend
+ * on the number of threads. Skim writes the few variables needed to a
+ * SkimStore, RunSkim refills the histograms from it under new cuts.
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef EVENTLOOP_H_
+#define EVENTLOOP_H_
+
+#include <vector>
+#include <map>
+#include "TString.h"
+#include "TH1D.h"
+#include "DataSample.h"
+#include "SkimStore.h"
+
+class EventLoop {
+
+private:
+	// Entries first_entry to last_entry - 1 of one input file
+	struct EntryRange {
+		unsigned int file_index;
+		Long64_t first_entry;
+		Long64_t last_entry;
+	};
+
+	// Contents and sumw2 of every variation, mode, region and jet bin
+	struct Accumulator {
+		std::vector<double> contents;
+		std::vector<double> sumw2;
+	};
+
+	std::vector<TString> input_files_;
+	TString tree_name_;
+	TString channel_;
+
+	// Branches, floats except the two jet counts which are ints. Without
+	// a weight branch every event counts once, as for data.
+	TString met_branch_;
+	TString iso_branch_;
+	TString n_jet_branch_;
+	TString n_tag_branch_;
+	TString weight_branch_;
+	double met_cut_;
+	double iso_cut_;
+
+	// Variation names and the weight branch used instead of the nominal
+	// one, the nominal weight is variation 0
+	std::vector<TString> variations_;
+	std::vector<TString> variation_branches_;
+
+	// Owned, filled by Run
+	std::map<TString, TH1D*> histos_;
+
+	unsigned int GetIndex(unsigned int variation, int mode, int region,
+			int bin) const;
+	std::vector<EntryRange> GetEntryRanges(void) const;
+	void ReadRange(const EntryRange& range, SkimColumns& columns) const;
+	void InitAccumulator(Accumulator& accumulator) const;
+	void FillEvents(uint64_t first_event, uint64_t last_event,
+			const float* met, const float* iso, const uint8_t* n_jet,
+			const uint8_t* n_tag, const std::vector<const float*>& weights,
+			Accumulator& accumulator) const;
+	void BuildHistos(const std::vector<Accumulator>& accumulators);
+	TString GetHistoName(TString mode, int region, TString variation) const;
+	void ClearHistos(void);
+
+	EventLoop(const EventLoop&);
+	EventLoop& operator=(const EventLoop&);
+
+public:
+	EventLoop(TString tree_name = "physics", TString channel = "el");
+	virtual ~EventLoop();
+
+	void AddInputFile(TString file_path);
+	// Adds every file matching a shell pattern, sorted. Exits if none
+	// does.
+	void AddInputFiles(TString pattern);
+
+	void SetMetBranch(TString branch) {
+		met_branch_ = branch;
+	}
+	void SetIsoBranch(TString branch) {
+		iso_branch_ = branch;
+	}
+	void SetNJetBranch(TString branch) {
+		n_jet_branch_ = branch;
+	}
+	void SetNTagBranch(TString branch) {
+		n_tag_branch_ = branch;
+	}
+	void SetWeightBranch(TString branch) {
+		weight_branch_ = branch;
+	}
+
+	// Cuts in the units of the branches
+	void SetMetCut(double met_cut) {
+		met_cut_ = met_cut;
+	}
+	void SetIsoCut(double iso_cut) {
+		iso_cut_ = iso_cut;
+	}
+
+	// Extra set of region histograms weighted by weight_branch
+	void AddWeightVariation(TString variation, TString weight_branch);
+
+	// Reads every input once and fills all histograms
+	void Run(void);
+
+	// Writes the selection variables of every input and the weight
+	// variations added so far to a skim, see SkimStore
+	bool Skim(TString skim_path);
+	// Fills all histograms from a skim instead of the ntuples, with the
+	// current cuts. The weight variations have to be in the skim.
+	void RunSkim(TString skim_path);
+
+	// Region histogram after Run, regions count from 0, "" is nominal
+	TH1D* GetHisto(TString mode, int region, TString variation = "") const;
+
+	// Hands the region histograms of a variation to a sample, see
+	// DataSample::SetRegionHistos
+	void Fill(DataSample* sample, TString variation = "") const;
+
+	// Writes every histogram, variations as <name>_<variation>
+	bool Write(TString output_path) const;
+};
+
+#endif /* EVENTLOOP_H_ */
@@ -0,0 +1,215 @@
+/*
+ * GridABCD.h
+ * Drives DataSample and ABCDReader objects to produce the QCD estimate
+ * with the matrix method on a NMet x NIso grid of regions, see
+ * GridEstimator. GridABCD<2, 2> reproduces DoABCD, the larger layouts
+ * are the extended ABCD methods used for the correlation systematic.
+ *
+ * The regions beyond A to D are read from h_njet_<mode>_M<m>I<i>_el, so
+ * the samples of a larger layout are set up with GetSampleSetup. The
+ * shifted drivers and the plain ABCD estimate are built once, on the
+ * same samples.
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef GRIDABCD_H_
+#define GRIDABCD_H_
+
+#include <vector>
+#include <algorithm>
+#include <mutex>
+#include <iostream>
+#include <math.h>
+#include "ABCDReader.h"
+#include "DataSample.h"
+#include "GridEstimator.h"
+#include "SampleSet.h"
+
+template<int NMet, int NIso>
+class GridABCD {
+
+public:
+	typedef GridEstimator<NMet, NIso> Estimator;
+	typedef typename Estimator::RegionArray RegionArray;
+
+private:
+	// Owns the shifted and plain drivers, and the sample set unless it
+	// was passed in
+	SampleSet* sample_set_;
+	bool owns_sample_set_;
+	// Readers of this configuration, owned by the sample set
+	const ReaderCollection* readers_;
+	// Reader region of the first grid region, ABCDReader regions count
+	// from 1
+	int first_region_;
+	// Built once by the first caller of GetNdSystError and
+	// GetCorrelationShift, on the same sample set
+	mutable std::once_flag syst_once_;
+	mutable GridABCD* syst_up_;
+	mutable GridABCD* syst_down_;
+	mutable std::once_flag plain_once_;
+	mutable GridABCD<2, 2>* plain_;
+
+	TString mode_;
+	bool is_inclusive_;
+	int jet_bin_;
+	int sys_mode_;
+
+	GridABCD(const GridABCD&);
+	GridABCD& operator=(const GridABCD&);
+
+	// Finds the grid regions among the region labels of the samples
+	void init(void) {
+		const std::vector<TString>& labels =
+				sample_set_->GetDataSample()->GetRegionLabels();
+		std::vector<TString> grid_labels = Estimator::RegionLabels();
+		std::vector<TString>::const_iterator found = std::search(
+				labels.begin(), labels.end(), grid_labels.begin(),
+				grid_labels.end());
+		if (found == labels.end()) {
+			std::cout << "GridABCD::init - Samples not set up for a "
+					<< NMet << "x" << NIso << " grid, see GetSampleSetup"
+					<< std::endl;
+			exit(-1);
+		}
+		first_region_ = (found - labels.begin()) + 1;
+		readers_ = &sample_set_->GetReaders(mode_, jet_bin_, is_inclusive_,
+				sys_mode_);
+	}
+
+	void buildSystDrivers(void) const {
+		syst_up_ = new GridABCD(mode_, is_inclusive_, jet_bin_, 2,
+				*sample_set_);
+		syst_down_ = new GridABCD(mode_, is_inclusive_, jet_bin_, 0,
+				*sample_set_);
+	}
+
+	RegionArray GetReaderYields(const ABCDReader* reader) const {
+		RegionArray yields;
+		for (int index = 0; index != Estimator::kNRegions; index++) {
+			yields[index] = reader->GetRegionYield(first_region_ + index);
+		}
+		return yields;
+	}
+
+	RegionArray GetReaderErrors(const ABCDReader* reader) const {
+		RegionArray errors;
+		for (int index = 0; index != Estimator::kNRegions; index++) {
+			errors[index] = reader->GetRegionError(first_region_ + index);
+		}
+		return errors;
+	}
+
+public:
+	// Every getter is const and only reads the readers, the shifted and
+	// plain drivers are built under once flags as for DoABCD. Reads the
+	// regions of the grid from the standard samples.
+	GridABCD(TString mode = "tag", bool is_inclusive = false, int jet_bin = 3,
+			int sys_mode = 1) :
+			sample_set_(new SampleSet(GetSampleSetup())), owns_sample_set_(
+					true), readers_(0), first_region_(1), syst_up_(0), syst_down_(
+					0), plain_(0), mode_(mode), is_inclusive_(is_inclusive), jet_bin_(
+					jet_bin), sys_mode_(sys_mode) {
+		this->init();
+	}
+
+	// Shares the samples and readers of a set built with GetSampleSetup,
+	// which has to outlive the driver
+	GridABCD(TString mode, bool is_inclusive, int jet_bin, int sys_mode,
+			SampleSet& samples) :
+			sample_set_(&samples), owns_sample_set_(false), readers_(0), first_region_(
+					1), syst_up_(0), syst_down_(0), plain_(0), mode_(mode), is_inclusive_(
+					is_inclusive), jet_bin_(jet_bin), sys_mode_(sys_mode) {
+		this->init();
+	}
+
+	virtual ~GridABCD() {
+		// The shifted and plain drivers read from the same sample set
+		delete syst_up_;
+		delete syst_down_;
+		delete plain_;
+
+		if (owns_sample_set_)
+			delete sample_set_;
+	}
+
+	// Sets the region labels of the grid on every sample of a set. Larger
+	// layouts keep A to D first, for the plain estimate of
+	// GetCorrelationShift.
+	static SampleSet::SampleSetup GetSampleSetup(void) {
+		return [](DataSample* sample) {
+			std::vector<TString> labels = GridEstimator<2, 2>::RegionLabels();
+			if (Estimator::kNRegions != 4) {
+				std::vector<TString> grid_labels = Estimator::RegionLabels();
+				labels.insert(labels.end(), grid_labels.begin(),
+						grid_labels.end());
+			}
+			sample->SetRegionLabels(labels);
+		};
+	}
+
+	RegionArray GetDataRegionYields(void) const {
+		return GetReaderYields(readers_->find("dataAllEgamma")->second);
+	}
+
+	// Data minus all MC samples in every region
+	RegionArray GetCorrectedRegionYields(void) const {
+		std::vector<RegionArray> corrections;
+		ReaderCollection::const_iterator iter = readers_->begin();
+		ReaderCollection::const_iterator iter_end = readers_->end();
+		for (; iter != iter_end; iter++) {
+			if (SampleSet::IsData(iter->first) == 0)
+				corrections.push_back(GetReaderYields(iter->second));
+		}
+		return Estimator::Correct(this->GetDataRegionYields(), corrections);
+	}
+
+	// Data and MC errors added in quadrature in every region
+	RegionArray GetRegionErrors(void) const {
+		std::vector<RegionArray> errors;
+		ReaderCollection::const_iterator iter = readers_->begin();
+		ReaderCollection::const_iterator iter_end = readers_->end();
+		for (; iter != iter_end; iter++) {
+			errors.push_back(GetReaderErrors(iter->second));
+		}
+		return Estimator::CombineErrors(errors);
+	}
+
+	double GetNdEstimate(void) const {
+		return Estimator::Estimate(this->GetCorrectedRegionYields());
+	}
+
+	double GetNdError(void) const {
+		return Estimator::Error(this->GetCorrectedRegionYields(),
+				this->GetRegionErrors());
+	}
+
+	double GetNdSystError(void) const {
+		std::call_once(syst_once_, [this]() {
+			this->buildSystDrivers();
+		});
+
+		double nominal = this->GetNdEstimate();
+		double up_est = syst_up_->GetNdEstimate();
+		double down_est = syst_down_->GetNdEstimate();
+
+		return std::max(fabs(up_est - nominal), fabs(down_est - nominal));
+	}
+
+	// Shift of the estimate with respect to the plain 2x2 ABCD method,
+	// read from regions A to D of the same samples
+	double GetCorrelationShift(void) const {
+		std::call_once(plain_once_, [this]() {
+			plain_ = new GridABCD<2, 2>(mode_, is_inclusive_, jet_bin_,
+					sys_mode_, *sample_set_);
+		});
+		return this->GetNdEstimate() - plain_->GetNdEstimate();
+	}
+};
+
+typedef GridABCD<2, 2> GridABCD2x2;
+typedef GridABCD<3, 2> GridABCD3x2;
+typedef GridABCD<3, 3> GridABCD3x3;
+
+#endif /* GRIDABCD_H_ */
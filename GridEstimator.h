@@ -0,0 +1,186 @@
+/*
+ * GridEstimator.h
+ * Matrix method on a NMet x NIso grid of regions in the MET x etcone20
+ * plane. The signal region is the last cell, (NMet - 1, NIso - 1), all
+ * others are control regions. The 2x2 grid is the plain ABCD method,
+ * larger grids correct for a correlation between MET and isolation.
+ *
+ * The log yields are extrapolated as
+ *   ln n(m,i) = a(m) + b(i) + c * m * i
+ * with c fitted by least squares to the interaction terms of the control
+ * cells away from the first row and column. The estimate is then a
+ * product of control yields raised to fixed exponents, which only depend
+ * on the layout and are known at compile time:
+ *   2x2: D = B * C / A
+ *   3x2: n(2,1) = n(2,0) n(0,0) n(1,1)^2 / (n(0,1) n(1,0)^2)
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef GRIDESTIMATOR_H_
+#define GRIDESTIMATOR_H_
+
+#include <array>
+#include <vector>
+#include <math.h>
+#include "TString.h"
+
+template<int NMet, int NIso>
+class GridEstimator {
+
+	static_assert(NMet >= 2 && NIso >= 2, "Need at least a 2x2 grid");
+
+private:
+	static constexpr int SumTo(int n) {
+		return n * (n + 1) / 2;
+	}
+	static constexpr int SumOfSquaresTo(int n) {
+		return n * (n + 1) * (2 * n + 1) / 6;
+	}
+
+	// Coordinates of the signal region
+	static constexpr int kMetSignal = NMet - 1;
+	static constexpr int kIsoSignal = NIso - 1;
+
+	// Sum of (m * i)^2 over the interaction cells, zero for 2x2
+	static constexpr int InteractionNorm() {
+		return SumOfSquaresTo(kMetSignal) * SumOfSquaresTo(kIsoSignal)
+				- (kMetSignal * kIsoSignal) * (kMetSignal * kIsoSignal);
+	}
+
+	// Sum of m * i over the interaction cells in row met_bin / column iso_bin
+	static constexpr int RowMoment(int met_bin) {
+		return met_bin * SumTo(kIsoSignal)
+				- (met_bin == kMetSignal ? kMetSignal * kIsoSignal : 0);
+	}
+	static constexpr int ColumnMoment(int iso_bin) {
+		return iso_bin * SumTo(kMetSignal)
+				- (iso_bin == kIsoSignal ? kMetSignal * kIsoSignal : 0);
+	}
+	static constexpr int TotalMoment() {
+		return SumTo(kMetSignal) * SumTo(kIsoSignal) - kMetSignal * kIsoSignal;
+	}
+
+	// Moment of the interaction term c picked up by cell (met_bin, iso_bin)
+	static constexpr int CellMoment(int met_bin, int iso_bin) {
+		return (met_bin == 0 && iso_bin == 0) ? TotalMoment() :
+				(iso_bin == 0) ? -RowMoment(met_bin) :
+				(met_bin == 0) ? -ColumnMoment(iso_bin) :
+				(met_bin == kMetSignal && iso_bin == kIsoSignal) ?
+						0 : met_bin * iso_bin;
+	}
+
+	static constexpr double BaseWeight(int met_bin, int iso_bin) {
+		return (met_bin == 0 && iso_bin == 0) ? -1. :
+				(met_bin == kMetSignal && iso_bin == 0) ? 1. :
+				(met_bin == 0 && iso_bin == kIsoSignal) ? 1. : 0.;
+	}
+
+public:
+	static constexpr int kNMet = NMet;
+	static constexpr int kNIso = NIso;
+	static constexpr int kNRegions = NMet * NIso;
+	static constexpr int kSignal = kNRegions - 1;
+
+	typedef std::array<double, kNRegions> RegionArray;
+
+	static constexpr int Index(int met_bin, int iso_bin) {
+		return met_bin * NIso + iso_bin;
+	}
+
+	// Exponent of region index in the estimate, zero for the signal region
+	static constexpr double Weight(int index) {
+		return BaseWeight(index / NIso, index % NIso)
+				+ (InteractionNorm() == 0 ?
+						0. :
+						double(kMetSignal * kIsoSignal)
+								* CellMoment(index / NIso, index % NIso)
+								/ InteractionNorm());
+	}
+
+	// Histogram label of a region, A to D for the 2x2 grid so that the
+	// standard h_njet_<mode>_<region>_el inputs are used
+	static TString RegionLabel(int index) {
+		if (kNRegions == 4) {
+			const char* labels[] = { "A", "B", "C", "D" };
+			return labels[index];
+		}
+		return TString::Format("M%iI%i", index / NIso, index % NIso);
+	}
+
+	static std::vector<TString> RegionLabels(void) {
+		std::vector<TString> labels;
+		for (int index = 0; index != kNRegions; index++) {
+			labels.push_back(RegionLabel(index));
+		}
+		return labels;
+	}
+
+	// Data minus the sum of the MC corrections, region by region
+	static RegionArray Correct(const RegionArray& data,
+			const std::vector<RegionArray>& corrections) {
+		RegionArray corrected = data;
+		for (unsigned int sample_idx = 0; sample_idx != corrections.size();
+				sample_idx++) {
+			const RegionArray& correction = corrections[sample_idx];
+			for (int index = 0; index != kNRegions; index++) {
+				corrected[index] -= correction[index];
+			}
+		}
+		return corrected;
+	}
+
+	// Errors of all samples added in quadrature, region by region
+	static RegionArray CombineErrors(const std::vector<RegionArray>& errors) {
+		RegionArray sum_sq;
+		sum_sq.fill(0.);
+		for (unsigned int sample_idx = 0; sample_idx != errors.size();
+				sample_idx++) {
+			const RegionArray& error = errors[sample_idx];
+			for (int index = 0; index != kNRegions; index++) {
+				sum_sq[index] += error[index] * error[index];
+			}
+		}
+		for (int index = 0; index != kNRegions; index++) {
+			sum_sq[index] = sqrt(sum_sq[index]);
+		}
+		return sum_sq;
+	}
+
+	// Estimate in the signal region from the corrected control yields.
+	// Beyond 2x2 the exponents can be fractional and the yields have to
+	// be positive.
+	static double Estimate(const RegionArray& corrected) {
+		double estimate = 1.;
+		for (int index = 0; index != kNRegions; index++) {
+			const double weight = Weight(index);
+			if (weight == 1.)
+				estimate *= corrected[index];
+			else if (weight == -1.)
+				estimate /= corrected[index];
+			else if (weight != 0.)
+				estimate *= pow(corrected[index], weight);
+		}
+		return estimate;
+	}
+
+	// Error on the estimate, (dN/N)^2 = sum (w * dn/n)^2
+	static double Error(const RegionArray& corrected,
+			const RegionArray& errors) {
+		double rel_sq = 0.;
+		for (int index = 0; index != kNRegions; index++) {
+			const double weight = Weight(index);
+			if (weight == 0.)
+				continue;
+			const double rel = weight * errors[index] / corrected[index];
+			rel_sq += rel * rel;
+		}
+		return Estimate(corrected) * sqrt(rel_sq);
+	}
+};
+
+typedef GridEstimator<2, 2> AbcdGridEstimator;
+typedef GridEstimator<3, 2> Abcd3x2GridEstimator;
+typedef GridEstimator<3, 3> Abcd3x3GridEstimator;
+
+#endif /* GRIDESTIMATOR_H_ */
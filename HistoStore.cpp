@@ -0,0 +1,233 @@
+/*
+ * HistoStore.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include "HistoStore.h"
+#include "TFile.h"
+#include "TH1.h"
+#include "TKey.h"
+#include "TList.h"
+#include <iostream>
+#include <vector>
+#include <string.h>
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+const char HistoStore::kMagic[8] = { 'H', 'S', 'T', 'O', 'R', 'E', 0, 0 };
+
+HistoStore::HistoStore(TString store_path) :
+		store_path_(store_path), mapping_(0), mapping_size_(0), index_(0), names_(
+				0), contents_(0), sumw2_(0), edges_(0), n_histos_(0) {
+	this->Map();
+}
+
+HistoStore::~HistoStore() {
+	if (mapping_ != 0)
+		munmap(mapping_, mapping_size_);
+	mapping_ = 0;
+}
+
+void HistoStore::Map() {
+	int fd = open(store_path_.Data(), O_RDONLY);
+	if (fd < 0) {
+		std::cout << "HistoStore::Map - Store NOT found: " << store_path_
+				<< std::endl;
+		return;
+	}
+
+	struct stat file_stat;
+	if (fstat(fd, &file_stat) != 0
+			|| size_t(file_stat.st_size) < sizeof(Header)) {
+		std::cout << "HistoStore::Map - Store too short: " << store_path_
+				<< std::endl;
+		close(fd);
+		return;
+	}
+
+	mapping_size_ = file_stat.st_size;
+	void* mapping = mmap(0, mapping_size_, PROT_READ, MAP_PRIVATE, fd, 0);
+	// The mapping stays valid after the descriptor is closed
+	close(fd);
+	if (mapping == MAP_FAILED) {
+		std::cout << "HistoStore::Map - Cannot map " << store_path_
+				<< std::endl;
+		return;
+	}
+	// Only a few bins of each histogram are read, do not read ahead
+	madvise(mapping, mapping_size_, MADV_RANDOM);
+
+	const char* base = (const char*) mapping;
+	const Header* header = (const Header*) base;
+	if (memcmp(header->magic, kMagic, sizeof(kMagic)) != 0
+			|| header->version != kVersion) {
+		std::cout << "HistoStore::Map - Not a version " << kVersion
+				<< " store: " << store_path_ << std::endl;
+		munmap(mapping, mapping_size_);
+		return;
+	}
+
+	size_t index_offset = Align(sizeof(Header));
+	size_t names_offset = index_offset
+			+ Align(header->n_histos * sizeof(IndexEntry));
+	size_t contents_offset = names_offset + Align(header->names_size);
+	size_t sumw2_offset = contents_offset + header->total_bins * sizeof(double);
+	size_t edges_offset = sumw2_offset + header->total_bins * sizeof(double);
+	size_t expected_size = edges_offset + header->total_edges * sizeof(double);
+
+	if (expected_size != mapping_size_) {
+		std::cout << "HistoStore::Map - Truncated store: " << store_path_
+				<< std::endl;
+		munmap(mapping, mapping_size_);
+		return;
+	}
+
+	mapping_ = mapping;
+	n_histos_ = header->n_histos;
+	index_ = (const IndexEntry*) (base + index_offset);
+	names_ = base + names_offset;
+	contents_ = (const double*) (base + contents_offset);
+	sumw2_ = (const double*) (base + sumw2_offset);
+	edges_ = (const double*) (base + edges_offset);
+
+	for (uint32_t histo_idx = 0; histo_idx != n_histos_; histo_idx++) {
+		lookup_[this->GetName(histo_idx)] = histo_idx;
+	}
+}
+
+TString HistoStore::GetName(int histo_index) const {
+	const IndexEntry& entry = index_[histo_index];
+	return TString(
+			std::string(names_ + entry.name_offset, entry.name_length));
+}
+
+int HistoStore::Find(TString histo_name) const {
+	std::map<TString, int>::const_iterator found = lookup_.find(histo_name);
+	return (found != lookup_.end()) ? found->second : -1;
+}
+
+HistoBins HistoStore::GetBins(int histo_index) const {
+	const IndexEntry& entry = index_[histo_index];
+	HistoBins bins;
+	bins.contents = contents_ + entry.first_bin;
+	bins.sumw2 = sumw2_ + entry.first_bin;
+	bins.n_bins = entry.n_bins;
+	return bins;
+}
+
+const double* HistoStore::GetEdges(int histo_index) const {
+	return edges_ + index_[histo_index].first_edge;
+}
+
+TString HistoStore::GetStorePathFor(TString root_path) {
+	TString store_path = root_path;
+	if (store_path.EndsWith(".root"))
+		store_path.Remove(store_path.Length() - 5);
+	store_path += ".hstore";
+	return store_path;
+}
+
+bool HistoStore::Convert(TString root_path, TString store_path) {
+	TFile* file = TFile::Open(root_path);
+	if (file == 0 || file->IsZombie()) {
+		std::cout << "HistoStore::Convert - Sample file NOT found: "
+				<< root_path << std::endl;
+		delete file;
+		return false;
+	}
+
+	std::vector<IndexEntry> index;
+	std::string names;
+	std::vector<double> contents;
+	std::vector<double> sumw2;
+	std::vector<double> edges;
+	std::map<TString, int> seen;
+
+	// Keys come highest cycle first, older cycles of a name are skipped
+	TIter next_key(file->GetListOfKeys());
+	while (TKey* key = (TKey*) next_key()) {
+		TString histo_name = key->GetName();
+		if (seen.count(histo_name) != 0)
+			continue;
+
+		TObject* object = key->ReadObj();
+		TH1* histo = dynamic_cast<TH1*>(object);
+		if (histo == 0 || histo->GetDimension() != 1) {
+			delete object;
+			continue;
+		}
+		seen[histo_name] = index.size();
+
+		IndexEntry entry;
+		entry.name_offset = names.size();
+		entry.name_length = histo_name.Length();
+		entry.n_bins = histo->GetNbinsX() + 2;
+		entry.first_bin = contents.size();
+		entry.first_edge = edges.size();
+		index.push_back(entry);
+		names.append(histo_name.Data(), histo_name.Length());
+
+		for (unsigned int bin = 0; bin != entry.n_bins; bin++) {
+			double error = histo->GetBinError(bin);
+			contents.push_back(histo->GetBinContent(bin));
+			sumw2.push_back(error * error);
+		}
+		for (unsigned int bin = 1; bin != entry.n_bins; bin++) {
+			edges.push_back(histo->GetXaxis()->GetBinLowEdge(bin));
+		}
+		delete histo;
+	}
+	file->Close();
+	delete file;
+
+	Header header;
+	memcpy(header.magic, kMagic, sizeof(kMagic));
+	header.version = kVersion;
+	header.n_histos = index.size();
+	header.total_bins = contents.size();
+	header.total_edges = edges.size();
+	header.names_size = names.size();
+
+	FILE* output = fopen(store_path.Data(), "wb");
+	if (output == 0) {
+		std::cout << "HistoStore::Convert - Cannot write " << store_path
+				<< std::endl;
+		return false;
+	}
+
+	const char padding[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+	size_t index_size = index.size() * sizeof(IndexEntry);
+	bool is_ok = true;
+	is_ok &= fwrite(&header, sizeof(Header), 1, output) == 1;
+	fwrite(padding, 1, Align(sizeof(Header)) - sizeof(Header), output);
+	if (index_size != 0)
+		is_ok &= fwrite(&index[0], index_size, 1, output) == 1;
+	fwrite(padding, 1, Align(index_size) - index_size, output);
+	if (!names.empty())
+		is_ok &= fwrite(names.data(), names.size(), 1, output) == 1;
+	fwrite(padding, 1, Align(names.size()) - names.size(), output);
+	if (!contents.empty()) {
+		is_ok &= fwrite(&contents[0], sizeof(double), contents.size(), output)
+				== contents.size();
+		is_ok &= fwrite(&sumw2[0], sizeof(double), sumw2.size(), output)
+				== sumw2.size();
+	}
+	if (!edges.empty())
+		is_ok &= fwrite(&edges[0], sizeof(double), edges.size(), output)
+				== edges.size();
+	is_ok &= fclose(output) == 0;
+
+	if (!is_ok) {
+		std::cout << "HistoStore::Convert - Write failed for " << store_path
+				<< std::endl;
+		return false;
+	}
+
+	std::cout << "HistoStore::Convert - " << index.size()
+			<< " histograms written to " << store_path << std::endl;
+	return true;
+}
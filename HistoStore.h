@@ -0,0 +1,121 @@
+/*
+ * HistoStore.h
+ * Columnar binary copy of the 1D histograms of a TopD3PDHistos ROOT file,
+ * read back through a read-only memory map. Opening a store only reads
+ * the header and the name index; bin contents are paged in when an
+ * estimate first touches them, so neither the ROOT I/O stack nor TH1D
+ * objects are needed to get at the yields.
+ *
+ * Layout, all in native byte order, every block 8 byte aligned:
+ *   Header
+ *   IndexEntry[n_histos]
+ *   names      (n_histos names, not null terminated)
+ *   contents   double[total_bins], all histograms one after the other
+ *   sumw2      double[total_bins], same order as the contents
+ *   edges      double[total_edges], n_bins - 1 low edges and the last
+ *              up edge of every histogram
+ * Bin counts include the under- and overflow bins, so bin i of a store
+ * histogram is bin i of the TH1D it came from.
+ *
+ * Stores are made with Convert, see ConvertHistoStore.sh.
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef HISTOSTORE_H_
+#define HISTOSTORE_H_
+
+#include <map>
+#include <stddef.h>
+#include <stdint.h>
+#include "TString.h"
+
+// Bins of one histogram including under- and overflow, not owned
+struct HistoBins {
+	const double* contents;
+	const double* sumw2;
+	unsigned int n_bins;
+};
+
+class HistoStore {
+
+private:
+	struct Header {
+		char magic[8];
+		uint32_t version;
+		uint32_t n_histos;
+		uint64_t total_bins;
+		uint64_t total_edges;
+		uint64_t names_size;
+	};
+
+	struct IndexEntry {
+		uint64_t name_offset;
+		uint32_t name_length;
+		uint32_t n_bins;
+		uint64_t first_bin;
+		uint64_t first_edge;
+	};
+
+	static const char kMagic[8];
+	static const uint32_t kVersion = 1;
+
+	TString store_path_;
+	void* mapping_;
+	size_t mapping_size_;
+
+	const IndexEntry* index_;
+	const char* names_;
+	const double* contents_;
+	const double* sumw2_;
+	const double* edges_;
+	uint32_t n_histos_;
+
+	// Histogram position in the index by name
+	std::map<TString, int> lookup_;
+
+	// Holds a mapping, copies would unmap it twice
+	HistoStore(const HistoStore&);
+	HistoStore& operator=(const HistoStore&);
+
+	void Map(void);
+	static size_t Align(size_t size) {
+		return (size + 7) & ~size_t(7);
+	}
+
+public:
+	HistoStore(TString store_path);
+	virtual ~HistoStore();
+
+	bool IsOpen(void) const {
+		return mapping_ != 0;
+	}
+	TString GetStorePath(void) const {
+		return store_path_;
+	}
+
+	unsigned int GetNHistos(void) const {
+		return n_histos_;
+	}
+	TString GetName(int histo_index) const;
+
+	// Index of a histogram, -1 if it is not in the store
+	int Find(TString histo_name) const;
+	HistoBins GetBins(int histo_index) const;
+	// n_bins - 1 edges, from the low edge of bin 1 to the up edge of the
+	// last bin
+	const double* GetEdges(int histo_index) const;
+
+	// Store files are recognised by their extension
+	static bool IsStorePath(TString path) {
+		return path.EndsWith(".hstore");
+	}
+	// ./TopD3PDHistos_ttbar_el.root -> ./TopD3PDHistos_ttbar_el.hstore
+	static TString GetStorePathFor(TString root_path);
+
+	// Writes every 1D histogram of root_path to store_path. Returns false
+	// if the ROOT file cannot be read or the store cannot be written.
+	static bool Convert(TString root_path, TString store_path);
+};
+
+#endif /* HISTOSTORE_H_ */
@@ -1,5 +1,9 @@
 #!/bin/bash
+# Generates qcdEstimationDict.C, which is not kept in the repository.
+# The headers use C++11 (std::mutex, std::atomic, lambdas), so this
+# needs the rootcling of ROOT 6; the CINT based rootcint of ROOT 5
+# cannot parse them.
 
 echo Making Dictionary
-rootcint -f qcdEstimationDict.C -c AbcdBase.h DataSample.h DoABCD.h ABCDReader.h DoRSMT.h RootLinkDef.h
-echo "Done! :-)"
\ No newline at end of file
+rootcling -f qcdEstimationDict.C AbcdBase.h HistoStore.h YieldStore.h SharedYieldSegment.h DataSample.h SkimStore.h EventLoop.h RegionYieldTable.h RegionCube.h SamplePrefetcher.h SampleGroup.h NormalisationTable.h ABCDReader.h SampleSet.h DoABCD.h DoRSMT.h QcdEstimator.h EstimatorRegistry.h EstimateCovariance.h GridEstimator.h GridABCD.h BoundaryScan.h RsmtSweep.h RsmtBootstrap.h DoTemplateFit.h ShardedCampaign.h ShapeVariations.h ShapeABCD.h RunTrace.h RootLinkDef.h || exit 1
+echo "Done! :-)"
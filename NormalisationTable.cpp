@@ -0,0 +1,123 @@
+/*
+ * NormalisationTable.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include "NormalisationTable.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <stdlib.h>
+
+NormalisationTable::NormalisationTable(double luminosity) :
+		luminosity_(luminosity) {
+}
+
+NormalisationTable::~NormalisationTable() {
+}
+
+bool NormalisationTable::ReadFile(TString path) {
+	std::ifstream input(path.Data());
+	if (!input.good()) {
+		std::cout << "NormalisationTable::ReadFile - Cannot read " << path
+				<< std::endl;
+		return false;
+	}
+
+	std::string line;
+	int line_number = 0;
+	while (std::getline(input, line)) {
+		line_number++;
+		std::istringstream fields(line);
+		std::string name;
+		if (!(fields >> name) || name[0] == '#')
+			continue;
+
+		if (name == "luminosity") {
+			if (!(fields >> luminosity_) || luminosity_ <= 0.) {
+				std::cout << "NormalisationTable::ReadFile - Bad luminosity in "
+						<< path << ":" << line_number << std::endl;
+				return false;
+			}
+			continue;
+		}
+
+		Entry entry;
+		if (!(fields >> entry.cross_section >> entry.k_factor
+				>> entry.sum_of_weights) || entry.sum_of_weights == 0.) {
+			std::cout << "NormalisationTable::ReadFile - Bad line in " << path
+					<< ":" << line_number << std::endl;
+			return false;
+		}
+		entries_[name] = entry;
+	}
+
+	// Every scale would be zero or negative
+	if (luminosity_ <= 0.) {
+		std::cout << "NormalisationTable::ReadFile - No positive luminosity in "
+				<< path << " or the table" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+void NormalisationTable::CheckLuminosity(const char* method) const {
+	if (luminosity_ <= 0.) {
+		std::cout << "NormalisationTable::" << method << " - Luminosity "
+				<< luminosity_ << " is not positive" << std::endl;
+		exit(-1);
+	}
+}
+
+void NormalisationTable::SetEntry(TString sample_name, double cross_section,
+		double k_factor, double sum_of_weights) {
+	Entry entry;
+	entry.cross_section = cross_section;
+	entry.k_factor = k_factor;
+	entry.sum_of_weights = sum_of_weights;
+	entries_[sample_name] = entry;
+}
+
+bool NormalisationTable::HasEntry(TString sample_name) const {
+	return entries_.count(sample_name) != 0;
+}
+
+double NormalisationTable::GetScale(TString sample_name) const {
+	std::map<TString, Entry>::const_iterator found = entries_.find(
+			sample_name);
+	if (found == entries_.end())
+		return 1.;
+	this->CheckLuminosity("GetScale");
+	const Entry& entry = found->second;
+	return luminosity_ * entry.cross_section * entry.k_factor
+			/ entry.sum_of_weights;
+}
+
+void NormalisationTable::Apply(DataSample* sample) const {
+	std::map<TString, Entry>::const_iterator found = entries_.find(
+			sample->GetSampleName());
+	if (found == entries_.end())
+		return;
+	this->CheckLuminosity("Apply");
+	const Entry& entry = found->second;
+	sample->SetNormalisation(entry.cross_section, entry.k_factor,
+			entry.sum_of_weights, luminosity_);
+}
+
+void NormalisationTable::Apply(const SampleCollection& samples) const {
+	SampleCollection::const_iterator iter = samples.begin();
+	SampleCollection::const_iterator iter_end = samples.end();
+	for (; iter != iter_end; iter++) {
+		this->Apply(iter->second);
+	}
+}
+
+void NormalisationTable::Apply(const SampleGroup* group) const {
+	std::vector<DataSample*> samples = group->GetLeafSamples();
+	for (unsigned int sample_idx = 0; sample_idx != samples.size();
+			sample_idx++) {
+		this->Apply(samples[sample_idx]);
+	}
+}
@@ -0,0 +1,73 @@
+/*
+ * NormalisationTable.h
+ * Cross-sections, k-factors and sums of weights of the MC samples, read
+ * from a text file so a new k-factor or luminosity only needs a rerun of
+ * the estimate:
+ *
+ *   # sample  cross_section[pb]  k_factor  sum_of_weights
+ *   luminosity 4713.11
+ *   ttbar      90.57  1.22  14983835
+ *   117360     1.82   1.00  299948
+ *
+ * Apply sets DataSample::SetNormalisation of every listed sample, the
+ * others (data, pre-scaled samples) are left as they are.
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef NORMALISATIONTABLE_H_
+#define NORMALISATIONTABLE_H_
+
+#include <map>
+#include "TString.h"
+#include "DataSample.h"
+#include "SampleGroup.h"
+
+class NormalisationTable {
+
+public:
+	struct Entry {
+		double cross_section;
+		double k_factor;
+		double sum_of_weights;
+	};
+
+private:
+	double luminosity_;
+	std::map<TString, Entry> entries_;
+
+	// Exits unless the luminosity is positive
+	void CheckLuminosity(const char* method) const;
+
+public:
+	NormalisationTable(double luminosity = 0.);
+	virtual ~NormalisationTable();
+
+	// Adds the lines of a metadata file, returns false if it cannot be
+	// read, a line is malformed or no positive luminosity is known after
+	// it
+	bool ReadFile(TString path);
+
+	void SetLuminosity(double luminosity) {
+		luminosity_ = luminosity;
+	}
+	double GetLuminosity(void) const {
+		return luminosity_;
+	}
+	void SetEntry(TString sample_name, double cross_section, double k_factor,
+			double sum_of_weights);
+	bool HasEntry(TString sample_name) const;
+	// luminosity * cross_section * k_factor / sum_of_weights, 1 if the
+	// sample is not listed. Exits for a listed sample while the luminosity
+	// is not positive, as does Apply.
+	double GetScale(TString sample_name) const;
+
+	// Has to be called before the samples are loaded, or they are read
+	// again
+	void Apply(DataSample* sample) const;
+	void Apply(const SampleCollection& samples) const;
+	// Every leaf of the group, e.g. one entry per DSID
+	void Apply(const SampleGroup* group) const;
+};
+
+#endif /* NORMALISATIONTABLE_H_ */
@@ -0,0 +1,45 @@
+/*
+ * ParallelFor.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef PARALLELFOR_H_
+#define PARALLELFOR_H_
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// Runs func(0) ... func(n_tasks - 1) on up to one thread per core
+template<class Function>
+void ParallelFor(unsigned int n_tasks, Function func) {
+	unsigned int n_threads = std::thread::hardware_concurrency();
+	if (n_threads == 0)
+		n_threads = 1;
+	if (n_threads > n_tasks)
+		n_threads = n_tasks;
+
+	if (n_threads <= 1) {
+		for (unsigned int task = 0; task != n_tasks; task++) {
+			func(task);
+		}
+		return;
+	}
+
+	std::atomic<unsigned int> next_task(0);
+	std::vector<std::thread> workers;
+	for (unsigned int thread_idx = 0; thread_idx != n_threads; thread_idx++) {
+		workers.push_back(std::thread([&]() {
+			for (unsigned int task = next_task++; task < n_tasks;
+					task = next_task++) {
+				func(task);
+			}
+		}));
+	}
+	for (unsigned int thread_idx = 0; thread_idx != n_threads; thread_idx++) {
+		workers[thread_idx].join();
+	}
+}
+
+#endif /* PARALLELFOR_H_ */
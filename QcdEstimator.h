@@ -0,0 +1,58 @@
+/*
+ * QcdEstimator.h
+ * Common interface of the QCD estimation methods. An estimator reads the
+ * readers of a SampleSet, so every method evaluated on the same set
+ * shares one load of the samples and one reader per configuration. New
+ * methods implement Evaluate and are added to EstimatorRegistry.
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef QCDESTIMATOR_H_
+#define QCDESTIMATOR_H_
+
+#include "TString.h"
+
+class SampleSet;
+
+class QcdEstimator {
+
+public:
+	// Jet selection and mode an estimate is made for
+	struct Config {
+		TString mode;
+		int jet_bin;
+		bool is_inclusive;
+	};
+
+	// Estimate in the signal region with its stat and syst errors
+	struct Result {
+		double estimate;
+		double stat_error;
+		double syst_error;
+	};
+
+private:
+	QcdEstimator(const QcdEstimator&);
+	QcdEstimator& operator=(const QcdEstimator&);
+
+protected:
+	// Not owned, it has to outlive the estimator
+	SampleSet* sample_set_;
+
+public:
+	QcdEstimator(SampleSet& samples) :
+			sample_set_(&samples) {
+	}
+	virtual ~QcdEstimator() {
+		sample_set_ = 0;
+	}
+
+	virtual TString GetName(void) const = 0;
+
+	// Called from any number of threads at once, the set only builds the
+	// readers of a configuration once
+	virtual Result Evaluate(const Config& config) const = 0;
+};
+
+#endif /* QCDESTIMATOR_H_ */
@@ -0,0 +1,106 @@
+/*
+ * RegionCube.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include "RegionCube.h"
+#include "AbcdBase.h"
+#include <limits>
+#include <algorithm>
+
+const double RegionCube::kOpen = std::numeric_limits<double>::infinity();
+
+// Running sums along etcone20, then the MET x etcone20 plane of each jet
+// cell is added to the one of the cells below
+RegionCube::RegionCube(TH3* histo) :
+		n_jet_cells_(histo->GetNbinsX() + 2), n_met_cells_(
+				histo->GetNbinsY() + 2), n_iso_cells_(histo->GetNbinsZ() + 2), binning_(
+				histo) {
+	content_table_.assign(
+			(n_jet_cells_ + 1) * (n_met_cells_ + 1) * (n_iso_cells_ + 1), 0.);
+	sumw2_table_.assign(content_table_.size(), 0.);
+
+	for (int jet_cell = 0; jet_cell != n_jet_cells_; jet_cell++) {
+		for (int met_cell = 0; met_cell != n_met_cells_; met_cell++) {
+			double row_content = 0.;
+			double row_sumw2 = 0.;
+			for (int iso_cell = 0; iso_cell != n_iso_cells_; iso_cell++) {
+				double error = histo->GetBinError(jet_cell, met_cell, iso_cell);
+				row_content += histo->GetBinContent(jet_cell, met_cell,
+						iso_cell);
+				row_sumw2 += error * error;
+
+				unsigned int cell = this->GetIndex(jet_cell + 1, met_cell + 1,
+						iso_cell + 1);
+				unsigned int below_jet = this->GetIndex(jet_cell, met_cell + 1,
+						iso_cell + 1);
+				unsigned int below_met = this->GetIndex(jet_cell + 1, met_cell,
+						iso_cell + 1);
+				unsigned int below_both = this->GetIndex(jet_cell, met_cell,
+						iso_cell + 1);
+				content_table_[cell] = row_content + content_table_[below_jet]
+						+ content_table_[below_met] - content_table_[below_both];
+				sumw2_table_[cell] = row_sumw2 + sumw2_table_[below_jet]
+						+ sumw2_table_[below_met] - sumw2_table_[below_both];
+			}
+		}
+	}
+}
+
+RegionCube::~RegionCube() {
+	binning_ = 0;
+}
+
+// Inclusion-exclusion over the eight corners of the box, an empty range
+// on any axis gives zero
+double RegionCube::BoxSum(const std::vector<double>& table,
+		const Box& box) const {
+	int jet_low = box.jet_low;
+	int jet_high = box.jet_high + 1;
+	int met_low = box.met_low;
+	int met_high = box.met_high + 1;
+	int iso_low = box.iso_low;
+	int iso_high = box.iso_high + 1;
+	if (jet_high <= jet_low || met_high <= met_low || iso_high <= iso_low)
+		return 0.;
+
+	return table[this->GetIndex(jet_high, met_high, iso_high)]
+			- table[this->GetIndex(jet_low, met_high, iso_high)]
+			- table[this->GetIndex(jet_high, met_low, iso_high)]
+			- table[this->GetIndex(jet_high, met_high, iso_low)]
+			+ table[this->GetIndex(jet_low, met_low, iso_high)]
+			+ table[this->GetIndex(jet_low, met_high, iso_low)]
+			+ table[this->GetIndex(jet_high, met_low, iso_low)]
+			- table[this->GetIndex(jet_low, met_low, iso_low)];
+}
+
+RegionCube::Box RegionCube::GetBox(int jet_bin, bool is_inclusive,
+		double met_low, double met_high, double iso_low,
+		double iso_high) const {
+	Box box;
+	box.jet_low = jet_bin + 1;
+	box.jet_high = box.jet_low;
+	if (is_inclusive != 0)
+		box.jet_high = std::min(19, n_jet_cells_ - 1);
+
+	box.met_low = (met_low == -kOpen) ?
+			0 : binning_->GetYaxis()->FindFixBin(met_low);
+	box.met_high = (met_high == kOpen) ?
+			n_met_cells_ - 1 : binning_->GetYaxis()->FindFixBin(met_high) - 1;
+	box.iso_low = (iso_low == -kOpen) ?
+			0 : binning_->GetZaxis()->FindFixBin(iso_low);
+	box.iso_high = (iso_high == kOpen) ?
+			n_iso_cells_ - 1 : binning_->GetZaxis()->FindFixBin(iso_high) - 1;
+	return box;
+}
+
+RegionCube::Box RegionCube::GetRegionBox(int region, int jet_bin,
+		bool is_inclusive, double met_cut, double iso_cut) const {
+	bool low_met = (region == AbcdBase::A || region == AbcdBase::B);
+	bool non_isolated = (region == AbcdBase::A || region == AbcdBase::C);
+
+	return this->GetBox(jet_bin, is_inclusive, low_met ? -kOpen : met_cut,
+			low_met ? met_cut : kOpen, non_isolated ? iso_cut : -kOpen,
+			non_isolated ? kOpen : iso_cut);
+}
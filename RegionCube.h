@@ -0,0 +1,76 @@
+/*
+ * RegionCube.h
+ * Yields of one mode of a sample in the njet x MET x etcone20 cube, read
+ * from the 3D histogram h_njet_met_etcone20_<mode>_<channel>. Summed-
+ * volume tables of the contents and sumw2 over all cells, including
+ * under- and overflow, make the yield of any jet range and any box in
+ * the MET x etcone20 plane eight lookups, so regions can be defined by
+ * their cut values instead of one histogram per region. Built once per
+ * sample and mode by DataSample::GetRegionCube.
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef REGIONCUBE_H_
+#define REGIONCUBE_H_
+
+#include <vector>
+#include "TH3.h"
+
+class RegionCube {
+
+public:
+	// Inclusive cell ranges along the three axes, cell 0 is the underflow
+	struct Box {
+		int jet_low;
+		int jet_high;
+		int met_low;
+		int met_high;
+		int iso_low;
+		int iso_high;
+	};
+
+private:
+	int n_jet_cells_;
+	int n_met_cells_;
+	int n_iso_cells_;
+	// Entry (j, m, i) is the sum over the cells below j, m and i
+	std::vector<double> content_table_;
+	std::vector<double> sumw2_table_;
+	// Binning only, the histogram is owned by the sample
+	TH3* binning_;
+
+	unsigned int GetIndex(int jet, int met, int iso) const {
+		return (jet * (n_met_cells_ + 1) + met) * (n_iso_cells_ + 1) + iso;
+	}
+	double BoxSum(const std::vector<double>& table, const Box& box) const;
+
+	RegionCube(const RegionCube&);
+	RegionCube& operator=(const RegionCube&);
+
+public:
+	RegionCube(TH3* histo);
+	virtual ~RegionCube();
+
+	// Cells of the jet selection, as RegionYieldTable::GetBinRange, and
+	// the MET and etcone20 cells of [met_low, met_high) x [iso_low,
+	// iso_high). A cut inside a bin is moved down to its lower edge, as
+	// in BoundaryScan; -kOpen and kOpen leave a side unbounded.
+	Box GetBox(int jet_bin, bool is_inclusive, double met_low, double met_high,
+			double iso_low, double iso_high) const;
+
+	// A and B are below the MET cut, A and C are non-isolated
+	Box GetRegionBox(int region, int jet_bin, bool is_inclusive,
+			double met_cut, double iso_cut) const;
+
+	double GetYield(const Box& box) const {
+		return this->BoxSum(content_table_, box);
+	}
+	double GetSumw2(const Box& box) const {
+		return this->BoxSum(sumw2_table_, box);
+	}
+
+	static const double kOpen;
+};
+
+#endif /* REGIONCUBE_H_ */
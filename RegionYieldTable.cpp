@@ -0,0 +1,59 @@
+/*
+ * RegionYieldTable.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include "RegionYieldTable.h"
+#include "DataSample.h"
+#include "RunTrace.h"
+#include <algorithm>
+
+RegionYieldTable::RegionYieldTable(const DataSample* sample) :
+		modes_(DataSample::GetModes()), n_regions_(sample->GetNRegions()), n_bins_(
+				0) {
+	TraceSpan span("reader", "RegionYieldTable",
+			sample->GetSampleName().Data());
+	const YieldStore& store = sample->GetYieldStore();
+
+	// All region histograms share the njet binning
+	n_bins_ = store.GetNBins(
+			store.Find(sample->GetRegionHistoName(modes_.at(0), 0)));
+
+	content_sums_.assign(modes_.size() * n_regions_ * (n_bins_ + 1), 0.);
+	sumw2_sums_.assign(modes_.size() * n_regions_ * (n_bins_ + 1), 0.);
+
+	for (unsigned int mode_idx = 0; mode_idx != modes_.size(); mode_idx++) {
+		for (unsigned int region_idx = 0; region_idx != n_regions_;
+				region_idx++) {
+			int entry = store.Find(
+					sample->GetRegionHistoName(modes_[mode_idx], region_idx));
+			unsigned int offset = this->GetOffset(mode_idx, region_idx + 1);
+			for (unsigned int bin = 0; bin != n_bins_; bin++) {
+				content_sums_[offset + bin + 1] = content_sums_[offset + bin]
+						+ store.GetBinContent(entry, bin);
+				sumw2_sums_[offset + bin + 1] = sumw2_sums_[offset + bin]
+						+ store.GetBinSumw2(entry, bin);
+			}
+		}
+	}
+}
+
+RegionYieldTable::~RegionYieldTable() {
+}
+
+int RegionYieldTable::GetModeIndex(TString mode) const {
+	for (unsigned int mode_idx = 0; mode_idx != modes_.size(); mode_idx++) {
+		if (modes_[mode_idx] == mode)
+			return mode_idx;
+	}
+	return -1;
+}
+
+void RegionYieldTable::GetBinRange(int jet_bin, bool is_inclusive,
+		int& first_bin, int& last_bin) const {
+	first_bin = jet_bin + 1;
+	last_bin = first_bin;
+	if (is_inclusive != 0)
+		last_bin = std::min(19, int(n_bins_) - 1);
+}
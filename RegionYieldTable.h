@@ -0,0 +1,70 @@
+/*
+ * RegionYieldTable.h
+ * Yields of one loaded DataSample for every mode, region and jet range.
+ * Running sums over the histogram bins of each mode and region are kept
+ * in one array, so any range of jet bins is two lookups and a
+ * difference. ABCDReader objects are views on the table of their
+ * sample, built once per sample by DataSample::GetYieldTable.
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef REGIONYIELDTABLE_H_
+#define REGIONYIELDTABLE_H_
+
+#include <vector>
+#include "TString.h"
+
+class DataSample;
+
+class RegionYieldTable {
+
+private:
+	std::vector<TString> modes_;
+	unsigned int n_regions_;
+	unsigned int n_bins_;
+	// [mode][region][bin], entry bin is the sum of the histogram bins
+	// below bin, n_bins_ + 1 entries per region
+	std::vector<double> content_sums_;
+	std::vector<double> sumw2_sums_;
+
+	unsigned int GetOffset(int mode_index, int region) const {
+		return (mode_index * n_regions_ + region - 1) * (n_bins_ + 1);
+	}
+
+public:
+	// Reads the region bins of a loaded sample
+	RegionYieldTable(const DataSample* sample);
+	virtual ~RegionYieldTable();
+
+	unsigned int GetNRegions(void) const {
+		return n_regions_;
+	}
+	unsigned int GetNBins(void) const {
+		return n_bins_;
+	}
+	// -1 for a mode the sample does not have
+	int GetModeIndex(TString mode) const;
+
+	// Sums over histogram bins first_bin to last_bin, regions count from
+	// AbcdBase::A
+	double GetYield(int mode_index, int region, int first_bin,
+			int last_bin) const {
+		unsigned int offset = this->GetOffset(mode_index, region);
+		return content_sums_[offset + last_bin + 1]
+				- content_sums_[offset + first_bin];
+	}
+	double GetSumw2(int mode_index, int region, int first_bin,
+			int last_bin) const {
+		unsigned int offset = this->GetOffset(mode_index, region);
+		return sumw2_sums_[offset + last_bin + 1]
+				- sumw2_sums_[offset + first_bin];
+	}
+
+	// Histogram bins of a jet selection, as DataSample::GetYield: bin
+	// jet_bin + 1, or up to bin 19 for n jets and more
+	void GetBinRange(int jet_bin, bool is_inclusive, int& first_bin,
+			int& last_bin) const;
+};
+
+#endif /* REGIONYIELDTABLE_H_ */
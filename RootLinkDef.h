@@ -4,8 +4,36 @@
 #pragma link off classes;
 #pragma link off functions;
 #pragma link C++ class AbcdBase+;
+#pragma link C++ class HistoStore;
+#pragma link C++ class YieldStore;
+#pragma link C++ class SharedYieldSegment;
 #pragma link C++ class DataSample+;
+#pragma link C++ class SkimStore;
+#pragma link C++ class EventLoop;
+#pragma link C++ class RegionYieldTable;
+#pragma link C++ class RegionCube;
+#pragma link C++ class SampleGroup;
+#pragma link C++ class NormalisationTable;
 #pragma link C++ class ABCDReader+;
+#pragma link C++ class SampleSet;
 #pragma link C++ class DoABCD+;
 #pragma link C++ class DoRSMT+;
+#pragma link C++ class QcdEstimator;
+#pragma link C++ class EstimatorRegistry;
+#pragma link C++ class EstimateCovariance;
+#pragma link C++ class SamplePrefetcher;
+#pragma link C++ class GridEstimator<2,2>;
+#pragma link C++ class GridEstimator<3,2>;
+#pragma link C++ class GridEstimator<3,3>;
+#pragma link C++ class GridABCD<2,2>;
+#pragma link C++ class GridABCD<3,2>;
+#pragma link C++ class GridABCD<3,3>;
+#pragma link C++ class BoundaryScan;
+#pragma link C++ class RsmtSweep;
+#pragma link C++ class RsmtBootstrap;
+#pragma link C++ class DoTemplateFit;
+#pragma link C++ class ShardedCampaign;
+#pragma link C++ class ShapeVariations;
+#pragma link C++ class ShapeABCD;
+#pragma link C++ class RunTrace;
 #endif
@@ -0,0 +1,223 @@
+/*
+ * RsmtBootstrap.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include "RsmtBootstrap.h"
+#include "AbcdBase.h"
+#include "ParallelFor.h"
+#include "RunTrace.h"
+#include "TRandom3.h"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <math.h>
+
+namespace {
+
+// Replicas per batch, enough for the per-replica loops to vectorise
+const unsigned int kBatchSize = 256;
+
+// Regions A to C, the ones R_smt is measured in
+const int kNRegions = 3;
+
+// One Poisson replica of a weighted yield, see the header. Yields without
+// entries or with negative weights are kept as they are.
+double DrawYield(TRandom3& random, double yield, double sumw2) {
+	if (yield <= 0. || sumw2 <= 0.)
+		return yield;
+	double mean_weight = sumw2 / yield;
+	return mean_weight * random.Poisson(yield / mean_weight);
+}
+
+} // End anonymous namespace
+
+RsmtBootstrap::RsmtBootstrap(int jet_bin, bool is_inclusive,
+		const SampleCollection& samples) :
+		jet_bin_(jet_bin), is_inclusive_(is_inclusive) {
+	SampleCollection::const_iterator iter = samples.begin();
+	for (; iter != samples.end(); iter++) {
+		bool is_data = iter->first.Contains("dataAllEgamma");
+		ABCDReader* pretag = new ABCDReader(iter->second, "pretag", jet_bin_,
+				is_inclusive_, 1);
+		ABCDReader* tag = new ABCDReader(iter->second, "tag", jet_bin_,
+				is_inclusive_, 1);
+		pretag_readers_.insert(
+				is_data ? pretag_readers_.begin() : pretag_readers_.end(),
+				pretag);
+		tag_readers_.insert(is_data ? tag_readers_.begin() : tag_readers_.end(),
+				tag);
+		is_data_.insert(is_data ? is_data_.begin() : is_data_.end(), is_data);
+	}
+
+	// Nominal values from the yields themselves
+	double tag_corrected[kNRegions];
+	double pretag_corrected[kNRegions];
+	for (int region_idx = 0; region_idx != kNRegions; region_idx++) {
+		tag_corrected[region_idx] = 0.;
+		pretag_corrected[region_idx] = 0.;
+		for (unsigned int sample_idx = 0; sample_idx != tag_readers_.size();
+				sample_idx++) {
+			double sign = is_data_[sample_idx] ? 1. : -1.;
+			tag_corrected[region_idx] += sign
+					* tag_readers_[sample_idx]->GetRegionYield(region_idx + 1);
+			pretag_corrected[region_idx] += sign
+					* pretag_readers_[sample_idx]->GetRegionYield(
+							region_idx + 1);
+		}
+	}
+	double* values[kNQuantities];
+	for (int quantity = 0; quantity != kNQuantities; quantity++) {
+		values[quantity] = &nominal_[quantity];
+	}
+	Evaluate(tag_corrected, pretag_corrected, 1, 1, values);
+}
+
+RsmtBootstrap::~RsmtBootstrap() {
+	for (unsigned int sample_idx = 0; sample_idx != tag_readers_.size();
+			sample_idx++) {
+		delete pretag_readers_[sample_idx];
+		delete tag_readers_[sample_idx];
+	}
+}
+
+// Corrected yields are laid out [region][replica] with stride replicas
+// per region. Written as plain loops over the replicas so the compiler
+// can vectorise them.
+void RsmtBootstrap::Evaluate(const double* tag_corrected,
+		const double* pretag_corrected, unsigned int n_replicas,
+		unsigned int stride, double** values) {
+	const double* tag_A = tag_corrected;
+	const double* tag_B = tag_corrected + stride;
+	const double* tag_C = tag_corrected + 2 * stride;
+	const double* pretag_A = pretag_corrected;
+	const double* pretag_B = pretag_corrected + stride;
+	const double* pretag_C = pretag_corrected + 2 * stride;
+
+	for (unsigned int replica = 0; replica < n_replicas; replica++) {
+		double rsmt_A = tag_A[replica] / pretag_A[replica];
+		double rsmt_B = tag_B[replica] / pretag_B[replica];
+		double rsmt_C = tag_C[replica] / pretag_C[replica];
+		double rsmt_wgt = (rsmt_A + rsmt_B + rsmt_C) / 3;
+		double pretag_estimate = pretag_B[replica] * pretag_C[replica]
+				/ pretag_A[replica];
+
+		values[kRsmtA][replica] = rsmt_A;
+		values[kRsmtB][replica] = rsmt_B;
+		values[kRsmtC][replica] = rsmt_C;
+		values[kRsmtWgt][replica] = rsmt_wgt;
+		values[kPretagEstimate][replica] = pretag_estimate;
+		values[kTagEstimate][replica] = pretag_estimate * rsmt_wgt;
+	}
+}
+
+// Replicas first_replica to first_replica + n_replicas - 1
+void RsmtBootstrap::FillBatch(unsigned int first_replica,
+		unsigned int n_replicas, unsigned int seed) {
+	TRandom3 random(seed);
+	std::vector<double> tag_corrected(kNRegions * n_replicas, 0.);
+	std::vector<double> pretag_corrected(kNRegions * n_replicas, 0.);
+
+	for (unsigned int sample_idx = 0; sample_idx != tag_readers_.size();
+			sample_idx++) {
+		double sign = is_data_[sample_idx] ? 1. : -1.;
+		for (int region_idx = 0; region_idx != kNRegions; region_idx++) {
+			double tag = tag_readers_[sample_idx]->GetRegionYield(
+					region_idx + 1);
+			double tag_error = tag_readers_[sample_idx]->GetRegionError(
+					region_idx + 1);
+			double pretag = pretag_readers_[sample_idx]->GetRegionYield(
+					region_idx + 1);
+			double pretag_error = pretag_readers_[sample_idx]->GetRegionError(
+					region_idx + 1);
+			double untag = pretag - tag;
+			double untag_sumw2 = std::max(
+					pretag_error * pretag_error - tag_error * tag_error, 0.);
+
+			double* tag_out = &tag_corrected[region_idx * n_replicas];
+			double* pretag_out = &pretag_corrected[region_idx * n_replicas];
+			for (unsigned int replica = 0; replica != n_replicas; replica++) {
+				double tag_draw = DrawYield(random, tag, tag_error * tag_error);
+				double untag_draw = DrawYield(random, untag, untag_sumw2);
+				tag_out[replica] += sign * tag_draw;
+				pretag_out[replica] += sign * (tag_draw + untag_draw);
+			}
+		}
+	}
+
+	double* values[kNQuantities];
+	for (int quantity = 0; quantity != kNQuantities; quantity++) {
+		values[quantity] = &replicas_[quantity][first_replica];
+	}
+	Evaluate(&tag_corrected[0], &pretag_corrected[0], n_replicas, n_replicas,
+			values);
+}
+
+void RsmtBootstrap::Run(unsigned int n_replicas, unsigned int seed) {
+	TraceSpan span("bootstrap", "RsmtBootstrap::Run", GetLabel().Data());
+	for (int quantity = 0; quantity != kNQuantities; quantity++) {
+		replicas_[quantity].assign(n_replicas, 0.);
+	}
+
+	unsigned int n_batches = (n_replicas + kBatchSize - 1) / kBatchSize;
+	ParallelFor(n_batches, [&](unsigned int batch) {
+		unsigned int first_replica = batch * kBatchSize;
+		unsigned int batch_size = std::min(kBatchSize,
+				n_replicas - first_replica);
+		// Never 0, which would seed TRandom3 from the clock
+		unsigned int batch_seed = seed * 1000003u + batch + 1;
+		if (batch_seed == 0)
+			batch_seed = 1;
+		this->FillBatch(first_replica, batch_size, batch_seed);
+	});
+}
+
+double RsmtBootstrap::GetMean(Quantity quantity) const {
+	const std::vector<double>& values = replicas_[quantity];
+	double sum = 0.;
+	for (unsigned int replica = 0; replica != values.size(); replica++) {
+		sum += values[replica];
+	}
+	return values.empty() ? 0. : sum / values.size();
+}
+
+double RsmtBootstrap::GetSpread(Quantity quantity) const {
+	const std::vector<double>& values = replicas_[quantity];
+	if (values.size() < 2)
+		return 0.;
+	double mean = this->GetMean(quantity);
+	double sum_sq = 0.;
+	for (unsigned int replica = 0; replica != values.size(); replica++) {
+		double diff = values[replica] - mean;
+		sum_sq += diff * diff;
+	}
+	return sqrt(sum_sq / (values.size() - 1));
+}
+
+TString RsmtBootstrap::GetLabel() const {
+	TString suffix = "";
+	if (is_inclusive_ != 0)
+		suffix = "inc ";
+
+	return TString::Format("%i jet %s", jet_bin_, suffix.Data());
+}
+
+// R_smt in %, then the estimates, each with its bootstrap spread
+void RsmtBootstrap::PrintTable() const {
+	TraceSpan span("output", "RsmtBootstrap::PrintTable");
+	std::cout << std::setprecision(4);
+	std::cout << "| " << this->GetLabel() << " (" << this->GetNReplicas()
+			<< " replicas) | ";
+	for (int quantity = kRsmtA; quantity <= kRsmtWgt; quantity++) {
+		std::cout << 100 * nominal_[quantity] << AbcdBase::pm
+				<< 100 * this->GetSpread(Quantity(quantity)) << "(boot) | ";
+	}
+	std::cout << std::setprecision(1) << std::fixed;
+	for (int quantity = kPretagEstimate; quantity <= kTagEstimate;
+			quantity++) {
+		std::cout << nominal_[quantity] << AbcdBase::pm
+				<< this->GetSpread(Quantity(quantity)) << "(boot) | ";
+	}
+	std::cout << std::endl;
+}
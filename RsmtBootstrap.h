@@ -0,0 +1,91 @@
+/*
+ * RsmtBootstrap.h
+ * Statistical uncertainty of R_smt, R_smt^wgt and the tag estimate from
+ * Poisson bootstrap replicas of the region yields, instead of the
+ * binomial approximation of DoRSMT. In every replica each sample and
+ * region gets
+ *   tag*     = w_t Poisson(n_t)
+ *   untag*   = w_u Poisson(n_u),   pretag* = tag* + untag*
+ * so tag stays a subset of pretag. n = yield^2 / sumw2 is the effective
+ * number of events and w = sumw2 / yield the mean weight, for data w = 1.
+ * The estimates are then recomputed replica by replica with the same
+ * formulas as DoRSMT.
+ *
+ * Replicas are made in batches, each with its own generator seeded from
+ * the batch index, so the replicas do not depend on the number of
+ * threads.
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef RSMTBOOTSTRAP_H_
+#define RSMTBOOTSTRAP_H_
+
+#include <vector>
+#include "TString.h"
+#include "ABCDReader.h"
+#include "DataSample.h"
+
+class RsmtBootstrap {
+
+public:
+	enum Quantity {
+		kRsmtA,
+		kRsmtB,
+		kRsmtC,
+		kRsmtWgt,
+		kPretagEstimate,
+		kTagEstimate,
+		kNQuantities
+	};
+
+private:
+	// Nominal readers of every sample, owned, data first
+	std::vector<ABCDReader*> pretag_readers_;
+	std::vector<ABCDReader*> tag_readers_;
+	std::vector<bool> is_data_;
+
+	int jet_bin_;
+	bool is_inclusive_;
+
+	double nominal_[kNQuantities];
+	// Replica values, [quantity][replica]
+	std::vector<double> replicas_[kNQuantities];
+
+	void FillBatch(unsigned int first_replica, unsigned int n_replicas,
+			unsigned int seed);
+	static void Evaluate(const double* tag_corrected,
+			const double* pretag_corrected, unsigned int n_replicas,
+			unsigned int stride, double** values);
+	TString GetLabel(void) const;
+
+	RsmtBootstrap(const RsmtBootstrap&);
+	RsmtBootstrap& operator=(const RsmtBootstrap&);
+
+public:
+	// Reads from already loaded samples, which have to outlive it
+	RsmtBootstrap(int jet_bin, bool is_inclusive,
+			const SampleCollection& samples);
+	virtual ~RsmtBootstrap();
+
+	// Makes n_replicas replicas, the same seed gives the same replicas
+	void Run(unsigned int n_replicas, unsigned int seed = 4357);
+
+	unsigned int GetNReplicas(void) const {
+		return replicas_[0].size();
+	}
+	// Value from the unfluctuated yields, as DoRSMT
+	double GetNominal(Quantity quantity) const {
+		return nominal_[quantity];
+	}
+	double GetReplica(Quantity quantity, unsigned int replica) const {
+		return replicas_[quantity].at(replica);
+	}
+	double GetMean(Quantity quantity) const;
+	// Standard deviation over the replicas
+	double GetSpread(Quantity quantity) const;
+
+	void PrintTable(void) const;
+};
+
+#endif /* RSMTBOOTSTRAP_H_ */
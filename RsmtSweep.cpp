@@ -0,0 +1,163 @@
+/*
+ * RsmtSweep.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include "RsmtSweep.h"
+#include "AbcdBase.h"
+#include "DoRSMT.h"
+#include "WorkStealingPool.h"
+#include <iostream>
+#include <iomanip>
+#include <math.h>
+
+RsmtSweep::RsmtSweep() :
+		sample_set_(new SampleSet()), owns_sample_set_(true) {
+	this->init();
+}
+
+RsmtSweep::RsmtSweep(SampleSet& samples) :
+		sample_set_(&samples), owns_sample_set_(false) {
+	this->init();
+}
+
+RsmtSweep::~RsmtSweep() {
+	if (owns_sample_set_)
+		delete sample_set_;
+}
+
+void RsmtSweep::init() {
+	for (int jet_bin = 1; jet_bin != 5; jet_bin++) {
+		this->AddJetBin(jet_bin, false);
+	}
+	this->AddJetBin(3, true);
+	this->AddJetBin(4, true);
+}
+
+void RsmtSweep::ClearJetBins() {
+	jet_bins_.clear();
+	is_inclusive_.clear();
+	results_.clear();
+}
+
+void RsmtSweep::AddJetBin(int jet_bin, bool is_inclusive) {
+	jet_bins_.push_back(jet_bin);
+	is_inclusive_.push_back(is_inclusive);
+}
+
+void RsmtSweep::Run(unsigned int n_threads) {
+	unsigned int n_configs = jet_bins_.size();
+	int regions[] = { AbcdBase::A, AbcdBase::B, AbcdBase::C };
+
+	// R_smt of the shifted drivers, filled by their own tasks
+	std::vector<double> rsmt_up(3 * n_configs);
+	std::vector<double> rsmt_down(3 * n_configs);
+
+	results_.assign(n_configs, Result());
+
+	{
+		WorkStealingPool pool(n_threads);
+
+		for (unsigned int config_idx = 0; config_idx != n_configs;
+				config_idx++) {
+			int jet_bin = jet_bins_[config_idx];
+			bool is_inclusive = is_inclusive_[config_idx];
+			Result& result = results_[config_idx];
+
+			pool.Submit([&, jet_bin, is_inclusive, config_idx]() {
+				DoRSMT nominal(jet_bin, is_inclusive, 1, *sample_set_);
+				result.jet_bin = jet_bin;
+				result.is_inclusive = is_inclusive;
+				for (int region_idx = 0; region_idx != 3; region_idx++) {
+					result.rsmt[region_idx] = nominal.GetRsmt(
+							regions[region_idx]);
+					result.rsmt_stat[region_idx] = nominal.GetRsmtStatError(
+							regions[region_idx]);
+				}
+				result.rsmt_wgt = nominal.GetRsmtWgt();
+				result.rsmt_wgt_stat = nominal.GetRsmtWgtStatErr();
+				result.rsmt_wgt_syst = nominal.GetRsmtWgtSystErr();
+				result.tag_estimate = nominal.GetTagEstimate();
+				result.tag_estimate_stat = nominal.GetTagEstimateStatError();
+				result.tag_estimate_syst = nominal.GetTagEstimateSystError();
+			});
+
+			pool.Submit([&, jet_bin, is_inclusive, config_idx]() {
+				DoRSMT up(jet_bin, is_inclusive, 2, *sample_set_);
+				for (int region_idx = 0; region_idx != 3; region_idx++) {
+					rsmt_up[3 * config_idx + region_idx] = up.GetRsmt(
+							regions[region_idx]);
+				}
+			});
+
+			pool.Submit([&, jet_bin, is_inclusive, config_idx]() {
+				DoRSMT down(jet_bin, is_inclusive, 0, *sample_set_);
+				for (int region_idx = 0; region_idx != 3; region_idx++) {
+					rsmt_down[3 * config_idx + region_idx] = down.GetRsmt(
+							regions[region_idx]);
+				}
+			});
+		}
+
+		pool.Wait();
+	}
+
+	// Same combination as DoRSMT::GetRsmtSystError
+	for (unsigned int config_idx = 0; config_idx != n_configs; config_idx++) {
+		Result& result = results_[config_idx];
+		for (int region_idx = 0; region_idx != 3; region_idx++) {
+			double nominal = result.rsmt[region_idx];
+			result.rsmt_syst[region_idx] = std::max(
+					fabs(rsmt_up[3 * config_idx + region_idx] - nominal),
+					fabs(rsmt_down[3 * config_idx + region_idx] - nominal));
+		}
+	}
+}
+
+TString RsmtSweep::GetLabel(unsigned int config_index) const {
+	TString suffix = "";
+	if (is_inclusive_.at(config_index) != 0)
+		suffix = "inc ";
+
+	// 3 jet inc
+	TString label = TString::Format("%i jet %s", jet_bins_.at(config_index),
+			suffix.Data());
+
+	return label;
+}
+
+// Same layout as DoRSMT::PrintRsmtTable, one row per jet bin
+void RsmtSweep::PrintRsmtTable() {
+	std::cout << std::setprecision(4);
+	for (unsigned int config_idx = 0; config_idx != results_.size();
+			config_idx++) {
+		const Result& result = results_[config_idx];
+		double r_smt_wgt = 100 * result.rsmt_wgt;
+
+		std::cout << "| " << this->GetLabel(config_idx) << " | ";
+		for (int region_idx = 0; region_idx != 3; region_idx++) {
+			std::cout << 100 * result.rsmt[region_idx] << AbcdBase::pm
+					<< 100 * result.rsmt_stat[region_idx] << "(stat)"
+					<< AbcdBase::pm << 100 * result.rsmt_syst[region_idx]
+					<< "(syst) | ";
+		}
+		std::cout << r_smt_wgt << AbcdBase::pm << 100 * result.rsmt_wgt_stat
+				<< AbcdBase::pm << result.rsmt_wgt_syst * r_smt_wgt
+				<< "(syst) | " << std::endl;
+	}
+	return;
+}
+
+void RsmtSweep::PrintEstimateTable() {
+	std::cout << std::setprecision(1);
+	for (unsigned int config_idx = 0; config_idx != results_.size();
+			config_idx++) {
+		const Result& result = results_[config_idx];
+		std::cout << "| " << this->GetLabel(config_idx) << " (tag) | "
+				<< std::fixed << result.tag_estimate << AbcdBase::pm
+				<< result.tag_estimate_stat << "(stat)" << AbcdBase::pm
+				<< result.tag_estimate_syst << "(syst) | " << std::endl;
+	}
+	return;
+}
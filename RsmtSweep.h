@@ -0,0 +1,81 @@
+/*
+ * RsmtSweep.h
+ * Evaluates R_smt, R_smt^wgt and the tag estimate for several jet bins
+ * at once. The samples and readers of one SampleSet are shared by all
+ * DoRSMT drivers, the nominal and shifted drivers of every jet bin run as
+ * separate tasks on a WorkStealingPool. Every value is computed by one
+ * task with the same code as DoRSMT, so the results do not depend on
+ * the number of threads.
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef RSMTSWEEP_H_
+#define RSMTSWEEP_H_
+
+#include <vector>
+#include "TString.h"
+#include "SampleSet.h"
+
+class RsmtSweep {
+
+public:
+	struct Result {
+		int jet_bin;
+		bool is_inclusive;
+
+		// Indexed by region - 1, for regions A to C
+		double rsmt[3];
+		double rsmt_stat[3];
+		double rsmt_syst[3];
+
+		double rsmt_wgt;
+		double rsmt_wgt_stat;
+		double rsmt_wgt_syst;
+
+		double tag_estimate;
+		double tag_estimate_stat;
+		double tag_estimate_syst;
+	};
+
+private:
+	// Owns the sample set unless it was passed in
+	SampleSet* sample_set_;
+	bool owns_sample_set_;
+
+	std::vector<int> jet_bins_;
+	std::vector<bool> is_inclusive_;
+	std::vector<Result> results_;
+
+	void init(void);
+	TString GetLabel(unsigned int config_index) const;
+
+	RsmtSweep(const RsmtSweep&);
+	RsmtSweep& operator=(const RsmtSweep&);
+
+public:
+	// Starts with the jet bins of the tables: 1 to 4, 3 inc and 4 inc
+	RsmtSweep(void);
+	// Shares the samples and readers of a set, which has to outlive the
+	// sweep
+	RsmtSweep(SampleSet& samples);
+	virtual ~RsmtSweep();
+
+	void ClearJetBins(void);
+	void AddJetBin(int jet_bin, bool is_inclusive);
+
+	// n_threads = 0 uses one thread per core
+	void Run(unsigned int n_threads = 0);
+
+	unsigned int GetNResults(void) const {
+		return results_.size();
+	}
+	const Result& GetResult(unsigned int config_index) const {
+		return results_.at(config_index);
+	}
+
+	void PrintRsmtTable(void);
+	void PrintEstimateTable(void);
+};
+
+#endif /* RSMTSWEEP_H_ */
@@ -0,0 +1,123 @@
+/*
+ * RunTrace.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include "RunTrace.h"
+#include <iostream>
+#include <stdio.h>
+#include <unistd.h>
+
+std::atomic<bool> RunTrace::is_enabled_(false);
+std::mutex RunTrace::mutex_;
+std::vector<RunTrace::Event> RunTrace::events_;
+unsigned int RunTrace::n_threads_ = 0;
+RunTrace::Clock::time_point RunTrace::origin_;
+
+void RunTrace::Start() {
+	std::lock_guard<std::mutex> lock(mutex_);
+	events_.clear();
+	origin_ = Clock::now();
+	is_enabled_ = true;
+}
+
+// Small thread numbers in order of first use, one track each
+unsigned int RunTrace::GetThreadIndex() {
+	static thread_local unsigned int thread_index = 0;
+	static thread_local bool has_index = false;
+	if (!has_index) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		thread_index = n_threads_++;
+		has_index = true;
+	}
+	return thread_index;
+}
+
+void RunTrace::Record(const char* category, const std::string& name,
+		Clock::time_point start, Clock::time_point end) {
+	Event event;
+	event.name = name;
+	event.category = category;
+	event.thread_index = GetThreadIndex();
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	event.start_us = std::chrono::duration<double, std::micro>(
+			start - origin_).count();
+	event.duration_us =
+			std::chrono::duration<double, std::micro>(end - start).count();
+	events_.push_back(event);
+}
+
+std::string RunTrace::Escape(const std::string& text) {
+	std::string escaped;
+	for (unsigned int char_idx = 0; char_idx != text.size(); char_idx++) {
+		char character = text[char_idx];
+		if (character == '"' || character == '\\')
+			escaped += '\\';
+		escaped += character;
+	}
+	return escaped;
+}
+
+bool RunTrace::Stop(TString output_path) {
+	is_enabled_ = false;
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	FILE* output = fopen(output_path.Data(), "w");
+	if (output == 0) {
+		std::cout << "RunTrace::Stop - Cannot write " << output_path
+				<< std::endl;
+		return false;
+	}
+
+	int pid = getpid();
+	// Entries are separated, not terminated, by commas
+	const char* separator = "";
+	fprintf(output, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+	for (unsigned int thread_idx = 0; thread_idx != n_threads_; thread_idx++) {
+		fprintf(output,
+				"%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%i,"
+						"\"tid\":%u,\"args\":{\"name\":\"thread %u\"}}",
+				separator, pid, thread_idx, thread_idx);
+		separator = ",";
+	}
+	for (unsigned int event_idx = 0; event_idx != events_.size();
+			event_idx++) {
+		const Event& event = events_[event_idx];
+		fprintf(output,
+				"%s\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\","
+						"\"ts\":%.3f,\"dur\":%.3f,\"pid\":%i,\"tid\":%u}",
+				separator, Escape(event.name).c_str(), event.category,
+				event.start_us, event.duration_us, pid, event.thread_index);
+		separator = ",";
+	}
+	fprintf(output, "\n]}\n");
+	fclose(output);
+
+	std::cout << "RunTrace::Stop - " << events_.size()
+			<< " spans written to " << output_path << std::endl;
+	events_.clear();
+	return true;
+}
+
+TraceSpan::TraceSpan(const char* category, const char* name,
+		const char* detail) :
+		category_(category), name_(name), is_active_(RunTrace::IsEnabled()) {
+	if (!is_active_)
+		return;
+	if (detail != 0)
+		detail_ = detail;
+	start_ = RunTrace::Clock::now();
+}
+
+TraceSpan::~TraceSpan() {
+	if (!is_active_)
+		return;
+	RunTrace::Clock::time_point end = RunTrace::Clock::now();
+
+	std::string name = name_;
+	if (!detail_.empty())
+		name += " " + detail_;
+	RunTrace::Record(category_, name, start_, end);
+}
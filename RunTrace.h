@@ -0,0 +1,84 @@
+/*
+ * RunTrace.h
+ * Optional timeline of a run in the Chrome trace-event format, to be
+ * opened in chrome://tracing or Perfetto. Each TraceSpan records one
+ * complete event on the track of the thread it ran on:
+ *
+ *   RunTrace::Start();
+ *   ... estimates ...
+ *   RunTrace::Stop("./qcd_trace.json");
+ *
+ * While no trace is started a span only checks a flag, so the spans can
+ * stay in the code.
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef RUNTRACE_H_
+#define RUNTRACE_H_
+
+#include <vector>
+#include <string>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include "TString.h"
+
+class RunTrace {
+
+public:
+	typedef std::chrono::steady_clock Clock;
+
+private:
+	struct Event {
+		std::string name;
+		const char* category;
+		double start_us;
+		double duration_us;
+		unsigned int thread_index;
+	};
+
+	static std::atomic<bool> is_enabled_;
+	static std::mutex mutex_;
+	static std::vector<Event> events_;
+	static unsigned int n_threads_;
+	static Clock::time_point origin_;
+
+	static unsigned int GetThreadIndex(void);
+	static std::string Escape(const std::string& text);
+
+public:
+	// Drops any earlier events and starts recording
+	static void Start(void);
+	// Stops recording and writes the events, returns false if the file
+	// cannot be written
+	static bool Stop(TString output_path);
+
+	static bool IsEnabled(void) {
+		return is_enabled_;
+	}
+
+	static void Record(const char* category, const std::string& name,
+			Clock::time_point start, Clock::time_point end);
+};
+
+// Times the enclosing scope. The name is only built while tracing, detail
+// is appended to it, e.g. TraceSpan span("io", "ReadFile", path.Data());
+class TraceSpan {
+
+private:
+	const char* category_;
+	const char* name_;
+	std::string detail_;
+	bool is_active_;
+	RunTrace::Clock::time_point start_;
+
+	TraceSpan(const TraceSpan&);
+	TraceSpan& operator=(const TraceSpan&);
+
+public:
+	TraceSpan(const char* category, const char* name, const char* detail = 0);
+	virtual ~TraceSpan();
+};
+
+#endif /* RUNTRACE_H_ */
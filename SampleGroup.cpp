@@ -0,0 +1,207 @@
+/*
+ * SampleGroup.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include "SampleGroup.h"
+#include "ABCDReader.h"
+#include "ParallelFor.h"
+#include "RunTrace.h"
+#include "SampleSet.h"
+#include "SamplePrefetcher.h"
+#include <iostream>
+
+int SampleGroup::Totals::Find(TString name) const {
+	for (unsigned int node = 0; node != names.size(); node++) {
+		if (names[node] == name)
+			return node;
+	}
+	return -1;
+}
+
+SampleGroup::SampleGroup(TString name, double norm_error) :
+		name_(name), norm_error_(norm_error), sample_(0) {
+}
+
+SampleGroup::~SampleGroup() {
+	for (unsigned int child_idx = 0; child_idx != children_.size();
+			child_idx++) {
+		delete children_[child_idx];
+	}
+	delete sample_;
+}
+
+SampleGroup* SampleGroup::GetGroup(TString name) {
+	for (unsigned int child_idx = 0; child_idx != children_.size();
+			child_idx++) {
+		if (children_[child_idx]->GetName() == name)
+			return children_[child_idx];
+	}
+	return 0;
+}
+
+SampleGroup* SampleGroup::AddGroup(TString name, double norm_error) {
+	if (sample_ != 0) {
+		std::cout << "SampleGroup::AddGroup - " << name_
+				<< " is a sample, it cannot hold groups" << std::endl;
+		return 0;
+	}
+	SampleGroup* group = this->GetGroup(name);
+	if (group == 0) {
+		group = new SampleGroup(name, norm_error);
+		children_.push_back(group);
+	}
+	return group;
+}
+
+DataSample* SampleGroup::AddSample(TString name, TString file_pattern,
+		double norm_error) {
+	SampleGroup* leaf = this->AddGroup(name, norm_error);
+	if (leaf == 0)
+		return 0;
+	if (!leaf->children_.empty()) {
+		std::cout << "SampleGroup::AddSample - " << name
+				<< " is a group, it cannot hold a sample" << std::endl;
+		return 0;
+	}
+
+	if (leaf->sample_ == 0)
+		leaf->sample_ = new DataSample(name);
+	if (file_pattern.Length() != 0)
+		leaf->sample_->AddInputFiles(file_pattern);
+	return leaf->sample_;
+}
+
+unsigned int SampleGroup::GetNLeaves() const {
+	if (sample_ != 0)
+		return 1;
+	unsigned int n_leaves = 0;
+	for (unsigned int child_idx = 0; child_idx != children_.size();
+			child_idx++) {
+		n_leaves += children_[child_idx]->GetNLeaves();
+	}
+	return n_leaves;
+}
+
+std::vector<DataSample*> SampleGroup::GetLeafSamples() const {
+	std::vector<const SampleGroup*> nodes;
+	std::vector<int> depths;
+	this->Flatten(nodes, depths, 0);
+
+	std::vector<DataSample*> samples;
+	for (unsigned int node = 0; node != nodes.size(); node++) {
+		if (nodes[node]->sample_ != 0)
+			samples.push_back(nodes[node]->sample_);
+	}
+	return samples;
+}
+
+void SampleGroup::Flatten(std::vector<const SampleGroup*>& nodes,
+		std::vector<int>& depths, int depth) const {
+	nodes.push_back(this);
+	depths.push_back(depth);
+	for (unsigned int child_idx = 0; child_idx != children_.size();
+			child_idx++) {
+		children_[child_idx]->Flatten(nodes, depths, depth + 1);
+	}
+}
+
+void SampleGroup::Load(DataSample* data_sample) {
+	SamplePrefetcher prefetcher;
+	std::vector<DataSample*> samples = this->GetLeafSamples();
+	for (unsigned int sample_idx = 0; sample_idx != samples.size();
+			sample_idx++) {
+		samples[sample_idx]->SetDataSample(data_sample);
+		prefetcher.Register(samples[sample_idx]);
+	}
+	for (unsigned int sample_idx = 0; sample_idx != samples.size();
+			sample_idx++) {
+		prefetcher.Wait(samples[sample_idx]);
+	}
+}
+
+SampleGroup::Totals SampleGroup::Reduce(TString mode, int jet_bin,
+		bool is_inclusive, int sys_mode) const {
+	TraceSpan span("correction", "SampleGroup::Reduce", name_.Data());
+
+	std::vector<const SampleGroup*> nodes;
+	Totals totals;
+	this->Flatten(nodes, totals.depths, 0);
+
+	totals.n_regions = 0;
+	for (unsigned int node = 0; node != nodes.size(); node++) {
+		totals.names.push_back(nodes[node]->name_);
+		if (nodes[node]->sample_ != 0 && totals.n_regions == 0)
+			totals.n_regions = nodes[node]->sample_->GetNRegions();
+	}
+	unsigned int n_regions = totals.n_regions;
+	totals.yields.assign(nodes.size() * n_regions, 0.);
+	totals.variances.assign(nodes.size() * n_regions, 0.);
+
+	// Leaves, each task writes only its own slots
+	ParallelFor(nodes.size(), [&](unsigned int node) {
+		DataSample* sample = nodes[node]->sample_;
+		if (sample == 0)
+			return;
+		for (unsigned int region_idx = 0; region_idx != n_regions;
+				region_idx++) {
+			double error = sample->GetYieldError(mode, region_idx, jet_bin,
+					is_inclusive);
+			totals.yields[node * n_regions + region_idx] = sample->GetYield(
+					mode, region_idx, jet_bin, is_inclusive);
+			totals.variances[node * n_regions + region_idx] = error * error;
+		}
+	});
+
+	// Children come after their parent in depth-first order, walking
+	// backwards every child is complete before it is added
+	for (unsigned int node = nodes.size(); node-- != 0;) {
+		const SampleGroup* group = nodes[node];
+
+		unsigned int child = node + 1;
+		for (unsigned int child_idx = 0; child_idx != group->children_.size();
+				child_idx++) {
+			for (unsigned int region_idx = 0; region_idx != n_regions;
+					region_idx++) {
+				totals.yields[node * n_regions + region_idx] +=
+						totals.yields[child * n_regions + region_idx];
+				totals.variances[node * n_regions + region_idx] +=
+						totals.variances[child * n_regions + region_idx];
+			}
+			// Skip the subtree of this child
+			unsigned int next = child + 1;
+			while (next != nodes.size()
+					&& totals.depths[next] > totals.depths[child])
+				next++;
+			child = next;
+		}
+
+		double factor = 1.;
+		if (sys_mode == 0)
+			factor -= group->norm_error_;
+		else if (sys_mode == 2)
+			factor += group->norm_error_;
+		for (unsigned int region_idx = 0; region_idx != n_regions;
+				region_idx++) {
+			totals.yields[node * n_regions + region_idx] *= factor;
+		}
+	}
+
+	return totals;
+}
+
+SampleGroup* SampleGroup::MakeDefaultBackgrounds() {
+	std::vector<std::string> sample_names = SampleSet::GetDefaultSamples();
+
+	SampleGroup* backgrounds = new SampleGroup("backgrounds");
+	for (unsigned int sample_idx = 0; sample_idx != sample_names.size();
+			sample_idx++) {
+		TString sample_name = sample_names.at(sample_idx);
+		if (SampleSet::IsData(sample_name))
+			continue;
+		backgrounds->AddSample(sample_name, "",
+				ABCDReader::GetSampleNormError(sample_name));
+	}
+	return backgrounds;
+}
@@ -0,0 +1,105 @@
+/*
+ * SampleGroup.h
+ * Background samples as a tree of groups, e.g.
+ *   backgrounds -> singleTop -> s, t, Wt -> one DataSample per DSID
+ * Leaves hold a DataSample, any node can carry a normalisation
+ * uncertainty that scales its subtotal for sys_mode 0 and 2, as
+ * ABCDReader does for a whole sample.
+ *
+ * Reduce sums the region yields and variances of every node for one
+ * configuration. The leaves are read in parallel and each node adds its
+ * children in the order they were added, so the totals do not depend on
+ * the number of threads. The subtotals of all groups are kept in the
+ * result, group tables need no extra pass.
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef SAMPLEGROUP_H_
+#define SAMPLEGROUP_H_
+
+#include <vector>
+#include "TString.h"
+#include "DataSample.h"
+
+class SampleGroup {
+
+public:
+	// Subtotals of every node in depth-first order, node 0 is the group
+	// Reduce was called on. Regions count from AbcdBase::A.
+	struct Totals {
+		unsigned int n_regions;
+		std::vector<TString> names;
+		std::vector<int> depths;
+		std::vector<double> yields;
+		std::vector<double> variances;
+
+		// Index of a node, -1 if there is none of that name
+		int Find(TString name) const;
+		double GetYield(unsigned int node, int region) const {
+			return yields.at(node * n_regions + region - 1);
+		}
+		double GetVariance(unsigned int node, int region) const {
+			return variances.at(node * n_regions + region - 1);
+		}
+	};
+
+private:
+	TString name_;
+	double norm_error_;
+	// Owned, a node has either children or a sample
+	std::vector<SampleGroup*> children_;
+	DataSample* sample_;
+
+	void Flatten(std::vector<const SampleGroup*>& nodes,
+			std::vector<int>& depths, int depth) const;
+
+	SampleGroup(const SampleGroup&);
+	SampleGroup& operator=(const SampleGroup&);
+
+public:
+	SampleGroup(TString name, double norm_error = 0.);
+	virtual ~SampleGroup();
+
+	TString GetName(void) const {
+		return name_;
+	}
+	double GetNormError(void) const {
+		return norm_error_;
+	}
+	void SetNormError(double norm_error) {
+		norm_error_ = norm_error;
+	}
+
+	// Child group, created on first use
+	SampleGroup* AddGroup(TString name, double norm_error = 0.);
+	// Leaf reading the files matching file_pattern, see
+	// DataSample::AddInputFiles. An empty pattern reads the default
+	// ./TopD3PDHistos_<name>_<channel>.root.
+	DataSample* AddSample(TString name, TString file_pattern = "",
+			double norm_error = 0.);
+	SampleGroup* GetGroup(TString name);
+
+	bool IsLeaf(void) const {
+		return sample_ != 0;
+	}
+	DataSample* GetSample(void) {
+		return sample_;
+	}
+	unsigned int GetNLeaves(void) const;
+	// Samples of all leaves below this group, depth first
+	std::vector<DataSample*> GetLeafSamples(void) const;
+
+	// Reads every leaf in the background, contaminations are taken from
+	// data_sample
+	void Load(DataSample* data_sample);
+
+	Totals Reduce(TString mode, int jet_bin, bool is_inclusive,
+			int sys_mode) const;
+
+	// ttbar, WJetsScaled, Zjets, singleTop and diBoson as single-file
+	// leaves with the normalisation errors of ABCDReader
+	static SampleGroup* MakeDefaultBackgrounds(void);
+};
+
+#endif /* SAMPLEGROUP_H_ */
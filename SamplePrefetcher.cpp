@@ -0,0 +1,77 @@
+/*
+ * SamplePrefetcher.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include "SamplePrefetcher.h"
+#include "RunTrace.h"
+#include <algorithm>
+
+unsigned int SamplePrefetcher::default_read_ahead_ = 2;
+
+SamplePrefetcher::SamplePrefetcher(unsigned int read_ahead) :
+		stop_(false), read_ahead_(read_ahead) {
+	for (unsigned int worker_idx = 0; worker_idx != read_ahead_;
+			worker_idx++) {
+		workers_.push_back(std::thread(&SamplePrefetcher::Work, this));
+	}
+}
+
+// Samples still queued are dropped, the ones being read are finished
+SamplePrefetcher::~SamplePrefetcher() {
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stop_ = true;
+		queue_.clear();
+	}
+	queue_cond_.notify_all();
+
+	for (unsigned int worker_idx = 0; worker_idx != workers_.size();
+			worker_idx++) {
+		workers_[worker_idx].join();
+	}
+}
+
+void SamplePrefetcher::Register(DataSample* sample) {
+	if (read_ahead_ == 0 || sample->IsLoaded())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		queue_.push_back(sample);
+	}
+	queue_cond_.notify_one();
+}
+
+void SamplePrefetcher::Wait(DataSample* sample) {
+	TraceSpan span("wait", "SamplePrefetcher::Wait",
+			sample->GetSampleName().Data());
+	{
+		// Not worth waiting for a worker to pick it up
+		std::lock_guard<std::mutex> lock(mutex_);
+		std::deque<DataSample*>::iterator queued = std::find(queue_.begin(),
+				queue_.end(), sample);
+		if (queued != queue_.end())
+			queue_.erase(queued);
+	}
+	// DataSample::Load blocks while a worker is still reading it
+	sample->Load();
+}
+
+void SamplePrefetcher::Work() {
+	while (true) {
+		DataSample* sample = 0;
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			while (!stop_ && queue_.empty()) {
+				queue_cond_.wait(lock);
+			}
+			if (stop_)
+				return;
+			sample = queue_.front();
+			queue_.pop_front();
+		}
+		sample->Load();
+	}
+}
@@ -0,0 +1,57 @@
+/*
+ * SamplePrefetcher.h
+ * Loads registered DataSamples in the background so that the
+ * histogram reads of later samples overlap with the computation on
+ * the samples that are already in memory.
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef SAMPLEPREFETCHER_H_
+#define SAMPLEPREFETCHER_H_
+
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "DataSample.h"
+
+class SamplePrefetcher {
+
+private:
+	std::deque<DataSample*> queue_;
+	std::vector<std::thread> workers_;
+	std::mutex mutex_;
+	std::condition_variable queue_cond_;
+	bool stop_;
+	unsigned int read_ahead_;
+
+	static unsigned int default_read_ahead_;
+
+	void Work(void);
+
+public:
+	// read_ahead is the number of samples read concurrently, 0 reads
+	// each sample on first use only
+	SamplePrefetcher(unsigned int read_ahead = default_read_ahead_);
+	virtual ~SamplePrefetcher();
+
+	// Queues the sample, its histograms are read as soon as a slot is free
+	void Register(DataSample* sample);
+	// Blocks until the sample is loaded, loading it here if still queued
+	void Wait(DataSample* sample);
+
+	unsigned int GetReadAhead(void) const {
+		return read_ahead_;
+	}
+
+	static void SetDefaultReadAhead(unsigned int read_ahead) {
+		default_read_ahead_ = read_ahead;
+	}
+	static unsigned int GetDefaultReadAhead(void) {
+		return default_read_ahead_;
+	}
+};
+
+#endif /* SAMPLEPREFETCHER_H_ */
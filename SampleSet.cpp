@@ -0,0 +1,168 @@
+/*
+ * SampleSet.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include "SampleSet.h"
+#include "RunTrace.h"
+#include <iostream>
+#include <math.h>
+
+SampleSet::SampleSet() :
+		owns_samples_(true), list_of_samples(GetDefaultSamples()), prefetcher_(
+				new SamplePrefetcher()) {
+	this->init(SampleSetup());
+}
+
+SampleSet::SampleSet(const SampleSetup& setup) :
+		owns_samples_(true), list_of_samples(GetDefaultSamples()), prefetcher_(
+				new SamplePrefetcher()) {
+	this->init(setup);
+}
+
+void SampleSet::init(const SampleSetup& setup) {
+	TraceSpan span("register", "SampleSet::RegisterSamples");
+	for (unsigned int sample_index = 0; sample_index != list_of_samples.size();
+			sample_index++) {
+		TString samplename = list_of_samples.at(sample_index);
+		DataSample* sample = new DataSample(samplename);
+		if (setup)
+			setup(sample);
+		sample_collection[samplename] = sample;
+		prefetcher_->Register(sample);
+	}
+
+	// The MC samples share the data sample instead of reading their own
+	DataSample* data = this->GetDataSample();
+	SampleCollection::iterator iter = sample_collection.begin();
+	SampleCollection::iterator iter_end = sample_collection.end();
+	for (; iter != iter_end; iter++) {
+		iter->second->SetDataSample(data);
+	}
+}
+
+SampleSet::SampleSet(const SampleCollection& samples) :
+		sample_collection(samples), owns_samples_(false), prefetcher_(0) {
+	std::vector<std::string> default_samples = GetDefaultSamples();
+	for (unsigned int sample_index = 0; sample_index != default_samples.size();
+			sample_index++) {
+		if (sample_collection.find(default_samples.at(sample_index))
+				!= sample_collection.end())
+			list_of_samples.push_back(default_samples.at(sample_index));
+	}
+}
+
+SampleSet::~SampleSet() {
+	// Stop background reads before the samples go away
+	delete prefetcher_;
+
+	std::map<TString, ReaderCollection*>::iterator cache_iter =
+			reader_cache_.begin();
+	std::map<TString, ReaderCollection*>::iterator cache_iter_end =
+			reader_cache_.end();
+	for (; cache_iter != cache_iter_end; cache_iter++) {
+		ReaderCollection::iterator iter = cache_iter->second->begin();
+		ReaderCollection::iterator iter_end = cache_iter->second->end();
+		for (; iter != iter_end; iter++) {
+			delete iter->second;
+		}
+		delete cache_iter->second;
+	}
+
+	if (owns_samples_) {
+		SampleCollection::iterator sample_iter = sample_collection.begin();
+		SampleCollection::iterator sample_iter_end = sample_collection.end();
+		for (; sample_iter != sample_iter_end; sample_iter++) {
+			delete sample_iter->second;
+		}
+	}
+}
+
+std::vector<std::string> SampleSet::GetDefaultSamples() {
+	std::vector<std::string> samples;
+	samples.push_back("dataAllEgamma");
+	samples.push_back("ttbar");
+	samples.push_back("WJetsScaled");
+	samples.push_back("Zjets");
+	samples.push_back("singleTop");
+	samples.push_back("diBoson");
+	return samples;
+}
+
+// Never inserts, unlike operator[]
+DataSample* SampleSet::GetDataSample() const {
+	SampleCollection::const_iterator found = sample_collection.find(
+			"dataAllEgamma");
+	if (found == sample_collection.end()) {
+		std::cout << "SampleSet::GetDataSample - No dataAllEgamma sample"
+				<< std::endl;
+		exit(-1);
+	}
+	return found->second;
+}
+
+TString SampleSet::GetReaderKey(TString mode, int jet_bin, bool is_inclusive,
+		int sys_mode) {
+	return TString::Format("%s_%i_%i_%i", mode.Data(), jet_bin,
+			is_inclusive ? 1 : 0, sys_mode);
+}
+
+const ReaderCollection& SampleSet::GetReaders(TString mode, int jet_bin,
+		bool is_inclusive, int sys_mode) {
+	TString key = GetReaderKey(mode, jet_bin, is_inclusive, sys_mode);
+	std::lock_guard<std::mutex> lock(reader_mutex_);
+	std::map<TString, ReaderCollection*>::iterator found = reader_cache_.find(
+			key);
+	if (found != reader_cache_.end())
+		return *found->second;
+
+	TraceSpan span("reader", "SampleSet::GetReaders", key.Data());
+	ReaderCollection* readers = new ReaderCollection();
+	for (unsigned int sample_index = 0; sample_index != list_of_samples.size();
+			sample_index++) {
+		TString samplename = list_of_samples.at(sample_index);
+		DataSample* sample = sample_collection.find(samplename)->second;
+		if (prefetcher_ != 0)
+			prefetcher_->Wait(sample);
+		(*readers)[samplename] = new ABCDReader(sample, mode, jet_bin,
+				is_inclusive, sys_mode);
+	}
+	reader_cache_[key] = readers;
+	return *readers;
+}
+
+double SampleSet::GetDataYield(const ReaderCollection& readers, int region) {
+	return readers.find("dataAllEgamma")->second->GetRegionYield(region);
+}
+
+double SampleSet::GetCorrection(const ReaderCollection& readers, int region) {
+	double correction = 0.;
+	ReaderCollection::const_iterator iter = readers.begin();
+	ReaderCollection::const_iterator iter_end = readers.end();
+	for (; iter != iter_end; iter++) {
+		if (IsData(iter->first) == 0)
+			correction += iter->second->GetRegionYield(region);
+	}
+	return correction;
+}
+
+double SampleSet::GetRegionError(const ReaderCollection& readers,
+		int region) {
+	double sum_error = 0.;
+	ReaderCollection::const_iterator iter = readers.begin();
+	ReaderCollection::const_iterator iter_end = readers.end();
+	for (; iter != iter_end; iter++) {
+		double reg_error = iter->second->GetRegionError(region);
+		sum_error += reg_error * reg_error;
+	}
+	return sqrt(sum_error);
+}
+
+TString SampleSet::GetJetLabel(int jet_bin, bool is_inclusive) {
+	TString suffix = "";
+	if (is_inclusive != 0)
+		suffix = "inc ";
+
+	return TString::Format("%i jet %s", jet_bin, suffix.Data());
+}
@@ -0,0 +1,93 @@
+/*
+ * SampleSet.h
+ * The data and MC samples of one run, loaded once, and the readers of
+ * every mode, jet selection and sys_mode built on them. DoABCD, DoRSMT
+ * and the estimators of EstimatorRegistry all read from a set, so any
+ * number of methods and configurations share one pass over the inputs
+ * and one reader per sample and configuration.
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef SAMPLESET_H_
+#define SAMPLESET_H_
+
+#include <vector>
+#include <string>
+#include <map>
+#include <mutex>
+#include <functional>
+#include "TString.h"
+#include "DataSample.h"
+#include "ABCDReader.h"
+#include "SamplePrefetcher.h"
+
+class SampleSet {
+
+public:
+	// Applied to every standard sample before it is read, e.g. to set
+	// the channel or region labels or to request histograms
+	typedef std::function<void(DataSample* sample)> SampleSetup;
+
+private:
+	// Owns the readers, and the samples unless they were passed in
+	SampleCollection sample_collection;
+	bool owns_samples_;
+	std::vector<std::string> list_of_samples;
+	SamplePrefetcher* prefetcher_;
+	// By configuration, see GetReaderKey
+	std::map<TString, ReaderCollection*> reader_cache_;
+	std::mutex reader_mutex_;
+
+	void init(const SampleSetup& setup);
+	static TString GetReaderKey(TString mode, int jet_bin, bool is_inclusive,
+			int sys_mode);
+
+	SampleSet(const SampleSet&);
+	SampleSet& operator=(const SampleSet&);
+
+public:
+	// Reads the standard samples in the background from construction on,
+	// the MC samples share the data sample
+	SampleSet(void);
+	// The same with every sample set up first, so the samples are still
+	// read only once
+	SampleSet(const SampleSetup& setup);
+	// Views already loaded samples, which have to outlive the set. Only
+	// the standard samples found in the collection get readers.
+	SampleSet(const SampleCollection& samples);
+	virtual ~SampleSet();
+
+	// dataAllEgamma and the five MC samples it is corrected with
+	static std::vector<std::string> GetDefaultSamples(void);
+	static bool IsData(TString sample_name) {
+		return sample_name.Contains("dataAllEgamma");
+	}
+
+	const SampleCollection& GetSamples(void) const {
+		return sample_collection;
+	}
+	DataSample* GetDataSample(void) const;
+	// The samples that get readers, data first
+	const std::vector<std::string>& GetSampleNames(void) const {
+		return list_of_samples;
+	}
+
+	// Built on the first call for a configuration and kept, safe to call
+	// from any number of threads
+	const ReaderCollection& GetReaders(TString mode, int jet_bin,
+			bool is_inclusive, int sys_mode);
+
+	// Sums over the readers of one configuration, regions count from
+	// AbcdBase::A
+	static double GetDataYield(const ReaderCollection& readers, int region);
+	// All samples but data
+	static double GetCorrection(const ReaderCollection& readers, int region);
+	// Errors of all samples added in quadrature
+	static double GetRegionError(const ReaderCollection& readers, int region);
+
+	// "3 jet inc ", the methods append the mode they report
+	static TString GetJetLabel(int jet_bin, bool is_inclusive);
+};
+
+#endif /* SAMPLESET_H_ */
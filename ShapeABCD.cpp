@@ -0,0 +1,246 @@
+/*
+ * ShapeABCD.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include "ShapeABCD.h"
+#include "ABCDReader.h"
+#include "ParallelFor.h"
+#include "RunTrace.h"
+#include "TFile.h"
+#include "TH1D.h"
+#include <iostream>
+#include <math.h>
+
+namespace {
+
+const char* kRegions[] = { "A", "B", "C", "D" };
+const char* kSystSuffixes[] = { "_normDown", "", "_normUp" };
+
+} // End anonymous namespace
+
+ShapeABCD::ShapeABCD(const SampleCollection& samples) {
+	sample_sets_.push_back(samples);
+	set_names_.push_back("");
+	variables_.push_back("h_njet");
+}
+
+ShapeABCD::~ShapeABCD() {
+}
+
+void ShapeABCD::AddSampleSet(TString set_name,
+		const SampleCollection& samples) {
+	sample_sets_.push_back(samples);
+	set_names_.push_back(set_name);
+	for (unsigned int var_idx = 0; var_idx != variables_.size(); var_idx++) {
+		this->RequestVariable(samples, variables_[var_idx]);
+	}
+}
+
+void ShapeABCD::AddVariable(TString variable) {
+	variables_.push_back(variable);
+	for (unsigned int set_idx = 0; set_idx != sample_sets_.size(); set_idx++) {
+		this->RequestVariable(sample_sets_[set_idx], variable);
+	}
+}
+
+TString ShapeABCD::GetHistoName(const SampleCollection& samples,
+		TString variable, TString mode, TString region) const {
+	TString channel = samples.begin()->second->GetChannel();
+	return TString::Format("%s_%s_%s_%s", variable.Data(), mode.Data(), region.Data(),
+			channel.Data());
+}
+
+// The njet histograms are always read, anything else has to be asked for
+void ShapeABCD::RequestVariable(const SampleCollection& samples,
+		TString variable) {
+	if (variable == "h_njet")
+		return;
+
+	std::vector<TString> modes = DataSample::GetModes();
+	SampleCollection::const_iterator iter = samples.begin();
+	for (; iter != samples.end(); iter++) {
+		for (unsigned int mode_idx = 0; mode_idx != modes.size(); mode_idx++) {
+			for (int region_idx = 0; region_idx != 4; region_idx++) {
+				iter->second->RequestHisto(
+						this->GetHistoName(samples, variable, modes[mode_idx],
+								kRegions[region_idx]));
+			}
+		}
+	}
+}
+
+// Region histograms come from the yield store, the others are TH1s
+void ShapeABCD::GetBins(DataSample* sample, TString histo_name, Bins& bins) {
+	const YieldStore& store = sample->GetYieldStore();
+	int entry = store.Find(histo_name);
+	if (entry >= 0) {
+		unsigned int n_bins = store.GetNBins(entry);
+		bins.contents.resize(n_bins);
+		bins.sumw2.resize(n_bins);
+		bins.edges.resize(n_bins - 1);
+		for (unsigned int bin = 0; bin != n_bins; bin++) {
+			bins.contents[bin] = store.GetBinContent(entry, bin);
+			bins.sumw2[bin] = store.GetBinSumw2(entry, bin);
+		}
+		for (unsigned int bin = 0; bin + 1 < n_bins; bin++) {
+			bins.edges[bin] = store.GetEdge(entry, bin);
+		}
+		return;
+	}
+
+	TH1* histo = sample->GetHisto(histo_name);
+	if (histo == 0) {
+		std::cout << "ShapeABCD::GetBins - " << histo_name << " NOT found in "
+				<< sample->GetSampleName() << std::endl;
+		exit(-1);
+	}
+	unsigned int n_bins = histo->GetNbinsX() + 2;
+	bins.contents.resize(n_bins);
+	bins.sumw2.resize(n_bins);
+	bins.edges.resize(n_bins - 1);
+	for (unsigned int bin = 0; bin != n_bins; bin++) {
+		double error = histo->GetBinError(bin);
+		bins.contents[bin] = histo->GetBinContent(bin);
+		bins.sumw2[bin] = error * error;
+	}
+	for (unsigned int bin = 1; bin != n_bins; bin++) {
+		bins.edges[bin - 1] = histo->GetXaxis()->GetBinLowEdge(bin);
+	}
+}
+
+void ShapeABCD::Transform(const double* b, const double* b_var,
+		unsigned int n_bins, double ratio, double ratio_var, double* d,
+		double* d_var) {
+	const double ratio_sq = ratio * ratio;
+	for (unsigned int bin = 0; bin < n_bins; bin++) {
+		d[bin] = ratio * b[bin];
+		d_var[bin] = ratio_sq * b_var[bin] + ratio_var * b[bin] * b[bin];
+	}
+}
+
+// The three sys_mode templates of one set, variable and mode. The samples
+// are read once, only the MC scale changes between them.
+void ShapeABCD::MakeTemplates(unsigned int set_index, TString variable,
+		TString mode, std::vector<Template>& templates) const {
+	const SampleCollection& samples = sample_sets_[set_index];
+
+	// Data first, then the MC samples in map order
+	std::vector<TString> names;
+	std::vector<Bins> region_bins[4];
+	SampleCollection::const_iterator iter = samples.begin();
+	for (; iter != samples.end(); iter++) {
+		if (iter->first.Contains("dataAllEgamma"))
+			names.insert(names.begin(), iter->first);
+		else
+			names.push_back(iter->first);
+	}
+	for (int region_idx = 0; region_idx != 4; region_idx++) {
+		region_bins[region_idx].resize(names.size());
+		for (unsigned int sample_idx = 0; sample_idx != names.size();
+				sample_idx++) {
+			GetBins(samples.find(names[sample_idx])->second,
+					this->GetHistoName(samples, variable, mode,
+							kRegions[region_idx]),
+					region_bins[region_idx][sample_idx]);
+		}
+	}
+	unsigned int n_bins = region_bins[1][0].contents.size();
+
+	for (int sys_mode = 0; sys_mode != 3; sys_mode++) {
+		// Corrected contents and variances of every region
+		std::vector<double> corrected[4];
+		std::vector<double> variances[4];
+		for (int region_idx = 0; region_idx != 4; region_idx++) {
+			corrected[region_idx] = region_bins[region_idx][0].contents;
+			variances[region_idx] = region_bins[region_idx][0].sumw2;
+			for (unsigned int sample_idx = 1; sample_idx != names.size();
+					sample_idx++) {
+				const Bins& mc = region_bins[region_idx][sample_idx];
+				double factor = ABCDReader::GetSampleSystFactor(
+						names[sample_idx], sys_mode);
+				for (unsigned int bin = 0; bin != n_bins; bin++) {
+					corrected[region_idx][bin] -= factor * mc.contents[bin];
+					variances[region_idx][bin] += mc.sumw2[bin];
+				}
+			}
+		}
+
+		double totals[4] = { 0., 0., 0., 0. };
+		double total_vars[4] = { 0., 0., 0., 0. };
+		for (int region_idx = 0; region_idx != 4; region_idx++) {
+			for (unsigned int bin = 0; bin != n_bins; bin++) {
+				totals[region_idx] += corrected[region_idx][bin];
+				total_vars[region_idx] += variances[region_idx][bin];
+			}
+		}
+
+		double ratio = totals[2] / totals[0];
+		double ratio_var = ratio * ratio
+				* (total_vars[2] / (totals[2] * totals[2])
+						+ total_vars[0] / (totals[0] * totals[0]));
+
+		Template shape;
+		shape.name = TString::Format("qcd_%s_%s%s%s%s",
+				TString(variable).ReplaceAll("h_", "").Data(), mode.Data(),
+				set_names_[set_index].Length() != 0 ? "_" : "",
+				set_names_[set_index].Data(), kSystSuffixes[sys_mode]);
+		shape.contents.resize(n_bins);
+		shape.variances.resize(n_bins);
+		shape.edges = region_bins[1][0].edges;
+		Transform(&corrected[1][0], &variances[1][0], n_bins, ratio, ratio_var,
+				&shape.contents[0], &shape.variances[0]);
+		templates.push_back(shape);
+	}
+}
+
+bool ShapeABCD::Write(TString output_path) {
+	TraceSpan span("output", "ShapeABCD::Write", output_path.Data());
+	std::vector<TString> modes = DataSample::GetModes();
+	unsigned int n_tasks = sample_sets_.size() * variables_.size()
+			* modes.size();
+
+	// One task per set, variable and mode, each fills its own slot
+	std::vector<std::vector<Template> > results(n_tasks);
+	ParallelFor(n_tasks, [&](unsigned int task) {
+		unsigned int mode_idx = task % modes.size();
+		unsigned int var_idx = (task / modes.size()) % variables_.size();
+		unsigned int set_idx = task / (modes.size() * variables_.size());
+		this->MakeTemplates(set_idx, variables_[var_idx], modes[mode_idx],
+				results[task]);
+	});
+
+	TFile* output = TFile::Open(output_path, "RECREATE");
+	if (output == 0 || output->IsZombie()) {
+		std::cout << "ShapeABCD::Write - Cannot write " << output_path
+				<< std::endl;
+		delete output;
+		return false;
+	}
+
+	unsigned int n_templates = 0;
+	for (unsigned int task = 0; task != n_tasks; task++) {
+		for (unsigned int shape_idx = 0; shape_idx != results[task].size();
+				shape_idx++) {
+			const Template& shape = results[task][shape_idx];
+			unsigned int n_bins = shape.contents.size();
+			TH1D* histo = new TH1D(shape.name, shape.name, n_bins - 2,
+					&shape.edges[0]);
+			histo->Sumw2();
+			for (unsigned int bin = 0; bin != n_bins; bin++) {
+				histo->SetBinContent(bin, shape.contents[bin]);
+				histo->SetBinError(bin, sqrt(shape.variances[bin]));
+			}
+			histo->SetDirectory(output);
+			histo->Write();
+			n_templates++;
+		}
+	}
+	output->Close();
+	delete output;
+
+	std::cout << "ShapeABCD::Write - " << n_templates
+			<< " templates written to " << output_path << std::endl;
+	return true;
+}
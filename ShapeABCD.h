@@ -0,0 +1,81 @@
+/*
+ * ShapeABCD.h
+ * QCD templates in region D, bin by bin: D_i = B_i * C / A, with B_i the
+ * corrected (data minus MC) yield in bin i of region B and C, A the
+ * corrected totals of regions C and A over the whole histogram,
+ * under- and overflow included. The errors are propagated as
+ *   dD_i^2 = (C/A)^2 dB_i^2 + B_i^2 (C/A)^2 (dC^2/C^2 + dA^2/A^2)
+ * with data and MC errors added in quadrature in every region.
+ *
+ * Templates are made for every variable (h_njet by default), mode, sample
+ * set and MC normalisation shift (sys_mode 0, 1, 2) and written to one
+ * file. Histograms other than h_njet are requested from the samples as
+ * <variable>_<mode>_<region>_<channel>, so the samples are best passed in
+ * before they are loaded.
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef SHAPEABCD_H_
+#define SHAPEABCD_H_
+
+#include <vector>
+#include "TString.h"
+#include "DataSample.h"
+
+class ShapeABCD {
+
+private:
+	// Bins of one histogram, under- and overflow included
+	struct Bins {
+		std::vector<double> contents;
+		std::vector<double> sumw2;
+		std::vector<double> edges;
+	};
+
+	// Template of one set, variable, mode and sys_mode
+	struct Template {
+		TString name;
+		std::vector<double> contents;
+		std::vector<double> variances;
+		std::vector<double> edges;
+	};
+
+	// Not owned
+	std::vector<SampleCollection> sample_sets_;
+	std::vector<TString> set_names_;
+	std::vector<TString> variables_;
+
+	TString GetHistoName(const SampleCollection& samples, TString variable,
+			TString mode, TString region) const;
+	void RequestVariable(const SampleCollection& samples, TString variable);
+	static void GetBins(DataSample* sample, TString histo_name, Bins& bins);
+	void MakeTemplates(unsigned int set_index, TString variable, TString mode,
+			std::vector<Template>& templates) const;
+
+	ShapeABCD(const ShapeABCD&);
+	ShapeABCD& operator=(const ShapeABCD&);
+
+public:
+	// The nominal samples, which have to outlive the estimator
+	ShapeABCD(const SampleCollection& samples);
+	virtual ~ShapeABCD();
+
+	// Another set of samples, e.g. a shape variation, written with
+	// set_name in the template names
+	void AddSampleSet(TString set_name, const SampleCollection& samples);
+	// Histogram base name, e.g. h_lep_pt for h_lep_pt_tag_B_el
+	void AddVariable(TString variable);
+
+	// D_i = ratio * b_i and its variance, for n_bins bins at once. ratio_var
+	// is the variance of ratio. Branch free so the compiler vectorises it.
+	static void Transform(const double* b, const double* b_var,
+			unsigned int n_bins, double ratio, double ratio_var, double* d,
+			double* d_var);
+
+	// qcd_<variable>_<mode>[_<set>][_normUp|_normDown] for every template,
+	// returns false if the file cannot be written
+	bool Write(TString output_path);
+};
+
+#endif /* SHAPEABCD_H_ */
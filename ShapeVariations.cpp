@@ -0,0 +1,240 @@
+/*
+ * ShapeVariations.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include "ShapeVariations.h"
+#include "DoABCD.h"
+#include "DoRSMT.h"
+#include "SampleSet.h"
+#include "SamplePrefetcher.h"
+#include "WorkStealingPool.h"
+#include <iostream>
+#include <iomanip>
+#include <math.h>
+
+ShapeVariations::ShapeVariations() :
+		sample_set_(new SampleSet()), owns_sample_set_(true) {
+	this->init();
+}
+
+ShapeVariations::ShapeVariations(SampleSet& samples) :
+		sample_set_(&samples), owns_sample_set_(false) {
+	this->init();
+}
+
+ShapeVariations::~ShapeVariations() {
+	std::map<TString, SampleCollection>::iterator var_iter =
+			variation_samples.begin();
+	for (; var_iter != variation_samples.end(); var_iter++) {
+		SampleCollection::iterator iter = var_iter->second.begin();
+		for (; iter != var_iter->second.end(); iter++) {
+			delete iter->second;
+		}
+	}
+
+	if (owns_sample_set_)
+		delete sample_set_;
+}
+
+void ShapeVariations::init() {
+	for (int jet_bin = 1; jet_bin != 5; jet_bin++) {
+		this->AddJetBin(jet_bin, false);
+	}
+	this->AddJetBin(3, true);
+	this->AddJetBin(4, true);
+}
+
+void ShapeVariations::AddVariationFiles(TString variation,
+		TString sample_name, TString file_pattern) {
+	if (sample_set_->GetSamples().count(sample_name) == 0) {
+		std::cout << "ShapeVariations::AddVariationFiles - Unknown sample "
+				<< sample_name << std::endl;
+		return;
+	}
+	if (SampleSet::IsData(sample_name)) {
+		std::cout << "ShapeVariations::AddVariationFiles - Data is never varied"
+				<< std::endl;
+		return;
+	}
+
+	if (variation_samples.count(variation) == 0)
+		variations_.push_back(variation);
+	SampleCollection& samples = variation_samples[variation];
+
+	// Same name and channel as the nominal sample so the same
+	// normalisation applies, the first matching file replaces the default
+	// input
+	if (samples.count(sample_name) == 0) {
+		samples[sample_name] = new DataSample(sample_name);
+		samples[sample_name]->SetChannel(
+				sample_set_->GetDataSample()->GetChannel());
+	}
+	samples[sample_name]->AddInputFiles(file_pattern);
+}
+
+void ShapeVariations::ClearJetBins() {
+	jet_bins_.clear();
+	is_inclusive_.clear();
+	results_.clear();
+}
+
+void ShapeVariations::AddJetBin(int jet_bin, bool is_inclusive) {
+	jet_bins_.push_back(jet_bin);
+	is_inclusive_.push_back(is_inclusive);
+}
+
+TString ShapeVariations::GetVariation(unsigned int variation_index) const {
+	if (variation_index == 0)
+		return "nominal";
+	return variations_.at(variation_index - 1);
+}
+
+const ShapeVariations::Result& ShapeVariations::GetResult(
+		unsigned int config_index, unsigned int variation_index) const {
+	return results_.at(config_index * (variations_.size() + 1)
+			+ variation_index);
+}
+
+// Reads every alternative sample once, they take their contaminations
+// from the nominal data. The nominal set reads its own samples.
+void ShapeVariations::LoadSamples() {
+	std::vector<DataSample*> samples;
+
+	std::map<TString, SampleCollection>::iterator var_iter =
+			variation_samples.begin();
+	for (; var_iter != variation_samples.end(); var_iter++) {
+		SampleCollection::iterator iter = var_iter->second.begin();
+		for (; iter != var_iter->second.end(); iter++) {
+			samples.push_back(iter->second);
+		}
+	}
+
+	SamplePrefetcher prefetcher;
+	for (unsigned int sample_idx = 0; sample_idx != samples.size();
+			sample_idx++) {
+		samples.at(sample_idx)->SetDataSample(sample_set_->GetDataSample());
+		prefetcher.Register(samples.at(sample_idx));
+	}
+	for (unsigned int sample_idx = 0; sample_idx != samples.size();
+			sample_idx++) {
+		prefetcher.Wait(samples.at(sample_idx));
+	}
+}
+
+// The nominal samples with the ones of the variation swapped in
+SampleCollection ShapeVariations::GetSamples(unsigned int variation_index) {
+	SampleCollection samples = sample_set_->GetSamples();
+	if (variation_index == 0)
+		return samples;
+
+	SampleCollection& varied = variation_samples[GetVariation(variation_index)];
+	SampleCollection::iterator iter = varied.begin();
+	for (; iter != varied.end(); iter++) {
+		samples[iter->first] = iter->second;
+	}
+	return samples;
+}
+
+void ShapeVariations::Run(unsigned int n_threads) {
+	this->LoadSamples();
+
+	unsigned int n_configs = jet_bins_.size();
+	unsigned int n_sets = variations_.size() + 1;
+
+	// One set per variation, its readers are shared by all jet bins. The
+	// nominal drivers use the readers of the nominal set.
+	std::vector<SampleSet*> sample_sets;
+	sample_sets.push_back(sample_set_);
+	for (unsigned int variation_idx = 1; variation_idx != n_sets;
+			variation_idx++) {
+		sample_sets.push_back(new SampleSet(this->GetSamples(variation_idx)));
+	}
+
+	results_.assign(n_configs * n_sets, Result());
+
+	{
+		WorkStealingPool pool(n_threads);
+
+		for (unsigned int config_idx = 0; config_idx != n_configs;
+				config_idx++) {
+			int jet_bin = jet_bins_[config_idx];
+			bool is_inclusive = is_inclusive_[config_idx];
+
+			for (unsigned int variation_idx = 0; variation_idx != n_sets;
+					variation_idx++) {
+				Result& result = results_[config_idx * n_sets + variation_idx];
+				SampleSet& samples = *sample_sets[variation_idx];
+
+				pool.Submit([&result, &samples, jet_bin, is_inclusive]() {
+					DoABCD tag_abcd("tag", is_inclusive, jet_bin, 1, samples);
+					DoRSMT rsmt(jet_bin, is_inclusive, 1, samples);
+					result.nd_tag = tag_abcd.getNdEstimate();
+					result.nd_pretag = rsmt.GetPretagEstimate();
+					result.rsmt_wgt = rsmt.GetRsmtWgt();
+					result.tag_estimate = rsmt.GetTagEstimate();
+				});
+			}
+		}
+
+		pool.Wait();
+	}
+
+	for (unsigned int variation_idx = 1; variation_idx != n_sets;
+			variation_idx++) {
+		delete sample_sets.at(variation_idx);
+	}
+}
+
+TString ShapeVariations::GetLabel(unsigned int config_index) const {
+	TString suffix = "";
+	if (is_inclusive_.at(config_index) != 0)
+		suffix = "inc ";
+
+	// 3 jet inc
+	TString label = TString::Format("%i jet %s", jet_bins_.at(config_index),
+			suffix.Data());
+
+	return label;
+}
+
+// One row per variation and jet bin, each value followed by its shift
+// from nominal in percent
+void ShapeVariations::PrintVariationTable() {
+	unsigned int n_sets = variations_.size() + 1;
+
+	std::cout
+			<< "| *Variation* | *Jet-bin* | *nD (pretag)* | *nD (tag)* | *R_smt^wgt (%)* | *nD R_smt (tag)* |"
+			<< std::endl;
+	for (unsigned int variation_idx = 0; variation_idx != n_sets;
+			variation_idx++) {
+		for (unsigned int config_idx = 0; config_idx != jet_bins_.size();
+				config_idx++) {
+			const Result& nominal = this->GetResult(config_idx, 0);
+			const Result& result = this->GetResult(config_idx, variation_idx);
+
+			double values[] = { result.nd_pretag, result.nd_tag, 100
+					* result.rsmt_wgt, result.tag_estimate };
+			double nominals[] = { nominal.nd_pretag, nominal.nd_tag, 100
+					* nominal.rsmt_wgt, nominal.tag_estimate };
+
+			std::cout << "| " << this->GetVariation(variation_idx) << " | "
+					<< this->GetLabel(config_idx) << " | ";
+			for (int value_idx = 0; value_idx != 4; value_idx++) {
+				std::cout << std::fixed << std::setprecision(2)
+						<< values[value_idx];
+				if (variation_idx != 0) {
+					std::cout << " ("
+							<< std::showpos
+							<< 100 * (values[value_idx] - nominals[value_idx])
+									/ nominals[value_idx] << "%)"
+							<< std::noshowpos;
+				}
+				std::cout << " | ";
+			}
+			std::cout << std::endl;
+		}
+	}
+	return;
+}
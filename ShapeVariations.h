@@ -0,0 +1,90 @@
+/*
+ * ShapeVariations.h
+ * Shape systematics (JES, JER, lepton scale factors, ...) given as
+ * alternative histogram files of some MC samples. Every variation swaps
+ * only its own samples into the nominal set, the data and all other
+ * samples are read once and shared. Run evaluates nD in pretag and tag,
+ * R_smt^wgt and the tag estimate for the nominal set and every variation
+ * in one pass, and the variation table lists the shifts with respect to
+ * nominal.
+ *
+ * The sys_mode normalisation shifts of ABCDReader are not applied here,
+ * all drivers run with sys_mode 1.
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef SHAPEVARIATIONS_H_
+#define SHAPEVARIATIONS_H_
+
+#include <vector>
+#include <map>
+#include "TString.h"
+#include "DataSample.h"
+#include "SampleSet.h"
+
+class ShapeVariations {
+
+public:
+	struct Result {
+		double nd_pretag;
+		double nd_tag;
+		double rsmt_wgt;
+		double tag_estimate;
+	};
+
+private:
+	// Owns the alternative samples, and the nominal set unless it was
+	// passed in
+	SampleSet* sample_set_;
+	bool owns_sample_set_;
+	std::map<TString, SampleCollection> variation_samples;
+	std::vector<TString> variations_;
+
+	std::vector<int> jet_bins_;
+	std::vector<bool> is_inclusive_;
+	// Indexed by config_index * (n_variations + 1) + variation_index,
+	// variation_index 0 is the nominal set
+	std::vector<Result> results_;
+
+	void init(void);
+	void LoadSamples(void);
+	SampleCollection GetSamples(unsigned int variation_index);
+	TString GetLabel(unsigned int config_index) const;
+
+	ShapeVariations(const ShapeVariations&);
+	ShapeVariations& operator=(const ShapeVariations&);
+
+public:
+	// Starts with the jet bins of the tables: 1 to 4, 3 inc and 4 inc
+	ShapeVariations(void);
+	// The nominal samples and readers of a set, which has to outlive the
+	// variations
+	ShapeVariations(SampleSet& samples);
+	virtual ~ShapeVariations();
+
+	// Alternative inputs of one MC sample under a variation, a shell
+	// pattern as for DataSample::AddInputFiles, e.g.
+	//   AddVariationFiles("JES_up", "ttbar", "./TopD3PDHistos_ttbar_JESup_el*.root")
+	// Exits if the pattern matches no file.
+	void AddVariationFiles(TString variation, TString sample_name,
+			TString file_pattern);
+
+	void ClearJetBins(void);
+	void AddJetBin(int jet_bin, bool is_inclusive);
+
+	// n_threads = 0 uses one thread per core
+	void Run(unsigned int n_threads = 0);
+
+	// Variation 0 is the nominal set, 1 to n the declared variations
+	unsigned int GetNVariations(void) const {
+		return variations_.size();
+	}
+	TString GetVariation(unsigned int variation_index) const;
+	const Result& GetResult(unsigned int config_index,
+			unsigned int variation_index) const;
+
+	void PrintVariationTable(void);
+};
+
+#endif /* SHAPEVARIATIONS_H_ */
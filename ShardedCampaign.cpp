@@ -0,0 +1,261 @@
+/*
+ * ShardedCampaign.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include "ShardedCampaign.h"
+#include "DataSample.h"
+#include "DoABCD.h"
+#include "DoRSMT.h"
+#include "SampleSet.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <map>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+ShardedCampaign::ShardedCampaign() {
+	channels_.push_back("el");
+	modes_.push_back("pretag");
+	modes_.push_back("tag");
+	for (int jet_bin = 1; jet_bin != 5; jet_bin++) {
+		jet_bins_.push_back(std::make_pair(jet_bin, false));
+	}
+	jet_bins_.push_back(std::make_pair(3, true));
+	jet_bins_.push_back(std::make_pair(4, true));
+	variations_.push_back(0);
+	variations_.push_back(1);
+	variations_.push_back(2);
+}
+
+ShardedCampaign::~ShardedCampaign() {
+}
+
+void ShardedCampaign::ClearChannels() {
+	channels_.clear();
+}
+
+void ShardedCampaign::AddChannel(TString channel) {
+	channels_.push_back(channel);
+}
+
+void ShardedCampaign::ClearModes() {
+	modes_.clear();
+}
+
+void ShardedCampaign::AddMode(TString mode) {
+	modes_.push_back(mode);
+}
+
+void ShardedCampaign::ClearJetBins() {
+	jet_bins_.clear();
+}
+
+void ShardedCampaign::AddJetBin(int jet_bin, bool is_inclusive) {
+	jet_bins_.push_back(std::make_pair(jet_bin, is_inclusive));
+}
+
+void ShardedCampaign::ClearVariations() {
+	variations_.clear();
+}
+
+void ShardedCampaign::AddVariation(int sys_mode) {
+	variations_.push_back(sys_mode);
+}
+
+unsigned int ShardedCampaign::GetNConfigs() const {
+	return channels_.size() * modes_.size() * jet_bins_.size()
+			* variations_.size();
+}
+
+ShardedCampaign::Config ShardedCampaign::GetConfig(
+		unsigned int config_index) const {
+	Config config;
+	unsigned int remainder = config_index;
+
+	config.sys_mode = variations_.at(remainder % variations_.size());
+	remainder /= variations_.size();
+	config.jet_bin = jet_bins_.at(remainder % jet_bins_.size()).first;
+	config.is_inclusive = jet_bins_.at(remainder % jet_bins_.size()).second;
+	remainder /= jet_bins_.size();
+	config.mode = modes_.at(remainder % modes_.size());
+	remainder /= modes_.size();
+	config.channel = channels_.at(remainder);
+
+	return config;
+}
+
+TString ShardedCampaign::GetShardPath(TString output_prefix,
+		unsigned int shard, unsigned int n_shards) {
+	return TString::Format("%s.shard%uof%u.txt", output_prefix.Data(), shard, n_shards);
+}
+
+void ShardedCampaign::WriteHeader(FILE* output) {
+	fprintf(output,
+			"# index channel mode jet_bin inclusive sys_mode nD nD_stat rsmt_wgt tag_estimate\n");
+}
+
+void ShardedCampaign::RunShard(unsigned int shard, unsigned int n_shards,
+		TString output_path) {
+	FILE* output = fopen(output_path.Data(), "w");
+	if (output == 0) {
+		std::cout << "ShardedCampaign::RunShard - Cannot write " << output_path
+				<< std::endl;
+		exit(-1);
+	}
+	WriteHeader(output);
+
+	// Samples of each channel are read once per shard, on first use, and
+	// ABCD and R_smt share the readers of every configuration
+	std::map<TString, SampleSet*> channel_sets;
+
+	for (unsigned int config_idx = shard; config_idx < this->GetNConfigs();
+			config_idx += n_shards) {
+		Config config = this->GetConfig(config_idx);
+
+		SampleSet*& sample_set = channel_sets[config.channel];
+		if (sample_set == 0) {
+			TString channel = config.channel;
+			sample_set = new SampleSet([channel](DataSample* sample) {
+				sample->SetChannel(channel);
+			});
+		}
+
+		DoABCD abcd(config.mode, config.is_inclusive, config.jet_bin,
+				config.sys_mode, *sample_set);
+		double nd_estimate = abcd.getNdEstimate();
+		double nd_error = abcd.getNdError();
+
+		// R_smt only applies to the tagged sample
+		double rsmt_wgt = 0.;
+		double tag_estimate = 0.;
+		if (!config.mode.Contains("pretag")) {
+			DoRSMT rsmt(config.jet_bin, config.is_inclusive, config.sys_mode,
+					*sample_set);
+			rsmt_wgt = rsmt.GetRsmtWgt();
+			tag_estimate = rsmt.GetTagEstimate();
+		}
+
+		fprintf(output, "%u %s %s %i %i %i %.17g %.17g %.17g %.17g\n",
+				config_idx, config.channel.Data(), config.mode.Data(),
+				config.jet_bin, config.is_inclusive ? 1 : 0, config.sys_mode,
+				nd_estimate, nd_error, rsmt_wgt, tag_estimate);
+	}
+
+	fclose(output);
+
+	std::map<TString, SampleSet*>::iterator channel_iter =
+			channel_sets.begin();
+	for (; channel_iter != channel_sets.end(); channel_iter++) {
+		delete channel_iter->second;
+	}
+}
+
+bool ShardedCampaign::RunForked(unsigned int n_shards,
+		TString output_prefix) {
+	std::vector<pid_t> children;
+	std::vector<TString> shard_paths;
+
+	for (unsigned int shard = 0; shard != n_shards; shard++) {
+		TString shard_path = GetShardPath(output_prefix, shard, n_shards);
+		shard_paths.push_back(shard_path);
+
+		pid_t pid = fork();
+		if (pid == 0) {
+			this->RunShard(shard, n_shards, shard_path);
+			_exit(0);
+		} else if (pid < 0) {
+			std::cout << "ShardedCampaign::RunForked - fork failed for shard "
+					<< shard << std::endl;
+			// Reap the shards already running before giving up
+			for (unsigned int child = 0; child != children.size(); child++) {
+				waitpid(children[child], 0, 0);
+			}
+			return false;
+		}
+		children.push_back(pid);
+	}
+
+	bool all_ok = true;
+	for (unsigned int shard = 0; shard != children.size(); shard++) {
+		int status = 0;
+		waitpid(children[shard], &status, 0);
+		if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+			std::cout << "ShardedCampaign::RunForked - Shard " << shard
+					<< " failed" << std::endl;
+			all_ok = false;
+		}
+	}
+	if (!all_ok)
+		return false;
+
+	return Merge(shard_paths, output_prefix + ".txt", this->GetNConfigs());
+}
+
+// The rows are copied as written, only reordered
+bool ShardedCampaign::Merge(const std::vector<TString>& shard_paths,
+		TString output_path, unsigned int n_configs) {
+	std::map<unsigned int, std::string> rows;
+
+	for (unsigned int shard = 0; shard != shard_paths.size(); shard++) {
+		std::ifstream input(shard_paths[shard].Data());
+		if (!input.good()) {
+			std::cout << "ShardedCampaign::Merge - Cannot read "
+					<< shard_paths[shard] << std::endl;
+			return false;
+		}
+
+		std::string line;
+		while (std::getline(input, line)) {
+			if (line.empty() || line[0] == '#')
+				continue;
+			std::istringstream fields(line);
+			unsigned int config_idx = 0;
+			if (!(fields >> config_idx)) {
+				std::cout << "ShardedCampaign::Merge - Bad line in "
+						<< shard_paths[shard] << ": " << line << std::endl;
+				return false;
+			}
+			if (config_idx >= n_configs) {
+				std::cout << "ShardedCampaign::Merge - Configuration "
+						<< config_idx << " out of range, expected "
+						<< n_configs << std::endl;
+				return false;
+			}
+			if (rows.count(config_idx) != 0) {
+				std::cout << "ShardedCampaign::Merge - Configuration "
+						<< config_idx << " appears twice" << std::endl;
+				return false;
+			}
+			rows[config_idx] = line;
+		}
+	}
+
+	// Indices are below n_configs, so any missing one shows in the count
+	if (rows.size() != n_configs) {
+		std::cout << "ShardedCampaign::Merge - " << rows.size() << " of "
+				<< n_configs << " configurations found" << std::endl;
+		return false;
+	}
+
+	FILE* output = fopen(output_path.Data(), "w");
+	if (output == 0) {
+		std::cout << "ShardedCampaign::Merge - Cannot write " << output_path
+				<< std::endl;
+		return false;
+	}
+	WriteHeader(output);
+	std::map<unsigned int, std::string>::iterator iter = rows.begin();
+	for (; iter != rows.end(); iter++) {
+		fprintf(output, "%s\n", iter->second.c_str());
+	}
+	fclose(output);
+
+	std::cout << "ShardedCampaign::Merge - " << rows.size()
+			<< " configurations written to " << output_path << std::endl;
+	return true;
+}
@@ -0,0 +1,85 @@
+/*
+ * ShardedCampaign.h
+ * Splits a full estimation campaign, every channel x mode x jet bin x
+ * variation, over several processes. Configurations are numbered in a
+ * fixed order and configuration i goes to shard i % n_shards, so every
+ * shard can be run independently, e.g. one batch job per shard running
+ *   ShardedCampaign campaign;
+ *   campaign.RunShard(shard, n_shards,
+ *       ShardedCampaign::GetShardPath(prefix, shard, n_shards));
+ * or all of them forked from one process with RunForked. Each shard
+ * writes its results with full double precision and, once every job is
+ * done, Merge(shard_paths, output_path, campaign.GetNConfigs())
+ * combines the shard files, so the merged table matches a
+ * single-process run bit for bit.
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef SHARDEDCAMPAIGN_H_
+#define SHARDEDCAMPAIGN_H_
+
+#include <vector>
+#include <utility>
+#include "TString.h"
+
+class ShardedCampaign {
+
+public:
+	struct Config {
+		TString channel;
+		TString mode;
+		int jet_bin;
+		bool is_inclusive;
+		int sys_mode;
+	};
+
+private:
+	std::vector<TString> channels_;
+	std::vector<TString> modes_;
+	std::vector<std::pair<int, bool> > jet_bins_;
+	std::vector<int> variations_;
+
+	static void WriteHeader(FILE* output);
+
+public:
+	// Starts with el, pretag and tag, jet bins 1 to 4, 3 inc and 4 inc,
+	// and sys_mode 0, 1 and 2
+	ShardedCampaign(void);
+	virtual ~ShardedCampaign();
+
+	void ClearChannels(void);
+	void AddChannel(TString channel);
+	void ClearModes(void);
+	void AddMode(TString mode);
+	void ClearJetBins(void);
+	void AddJetBin(int jet_bin, bool is_inclusive);
+	void ClearVariations(void);
+	void AddVariation(int sys_mode);
+
+	unsigned int GetNConfigs(void) const;
+	// Channel varies slowest, variation fastest
+	Config GetConfig(unsigned int config_index) const;
+
+	static unsigned int GetShard(unsigned int config_index,
+			unsigned int n_shards) {
+		return config_index % n_shards;
+	}
+	static TString GetShardPath(TString output_prefix, unsigned int shard,
+			unsigned int n_shards);
+
+	// Runs the configurations of one shard and writes them to output_path
+	void RunShard(unsigned int shard, unsigned int n_shards,
+			TString output_path);
+	// Forks one process per shard, waits for them and merges the results
+	// into <output_prefix>.txt. Returns false if a shard failed.
+	bool RunForked(unsigned int n_shards, TString output_prefix);
+
+	// Combines shard files, ordered by configuration index. Returns false
+	// unless every index from 0 to n_configs - 1 appears exactly once,
+	// e.g. for a truncated shard file.
+	static bool Merge(const std::vector<TString>& shard_paths,
+			TString output_path, unsigned int n_configs);
+};
+
+#endif /* SHARDEDCAMPAIGN_H_ */
@@ -0,0 +1,319 @@
+/*
+ * SharedYieldSegment.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include "SharedYieldSegment.h"
+#include <iostream>
+#include <string>
+#include <map>
+#include <mutex>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <signal.h>
+#include <stdlib.h>
+
+const char SharedYieldSegment::kMagic[8] = { 'Y', 'S', 'E', 'G', 'M', 'E',
+		'N', 'T' };
+
+namespace {
+
+// FNV-1a, 64 bit
+void HashBytes(uint64_t& hash, const void* data, size_t size) {
+	const unsigned char* bytes = (const unsigned char*) data;
+	for (size_t byte = 0; byte != size; byte++) {
+		hash ^= bytes[byte];
+		hash *= 1099511628211ull;
+	}
+}
+
+void HashString(uint64_t& hash, TString text) {
+	// The terminator keeps "ab" + "c" apart from "a" + "bc"
+	HashBytes(hash, text.Data(), text.Length() + 1);
+}
+
+// Pending segment names with the pid that claimed them, a forked child
+// exiting must not remove the segments of its parent
+std::map<std::string, pid_t>& GetPending(void) {
+	static std::map<std::string, pid_t> pending;
+	return pending;
+}
+
+std::mutex& GetPendingMutex(void) {
+	static std::mutex pending_mutex;
+	return pending_mutex;
+}
+
+std::once_flag pending_once;
+
+} // End anonymous namespace
+
+SharedYieldSegment::SharedYieldSegment(uint64_t key) :
+		key_(key), is_owner_(false), is_published_(false), mapping_(0), mapping_size_(
+				0) {
+	name_ = TString::Format("/qcdYields_%016llx", (unsigned long long) key_);
+}
+
+SharedYieldSegment::~SharedYieldSegment() {
+	if (mapping_ != 0)
+		munmap(mapping_, mapping_size_);
+	mapping_ = 0;
+	if (is_owner_ && !is_published_) {
+		shm_unlink(name_.Data());
+		RemovePending(name_);
+	}
+}
+
+void SharedYieldSegment::AddPending(TString name) {
+	// The statics exist before the handler is registered, so they are
+	// destroyed after it runs
+	GetPending();
+	GetPendingMutex();
+	std::call_once(pending_once, []() {
+		atexit(SharedYieldSegment::RemoveAllPending);
+	});
+	std::lock_guard<std::mutex> lock(GetPendingMutex());
+	GetPending()[name.Data()] = getpid();
+}
+
+void SharedYieldSegment::RemovePending(TString name) {
+	std::lock_guard<std::mutex> lock(GetPendingMutex());
+	GetPending().erase(name.Data());
+}
+
+// Runs at exit, e.g. from one of the exit(-1) of DataSample::Load
+void SharedYieldSegment::RemoveAllPending() {
+	std::lock_guard<std::mutex> lock(GetPendingMutex());
+	std::map<std::string, pid_t>& pending = GetPending();
+	std::map<std::string, pid_t>::iterator iter = pending.begin();
+	for (; iter != pending.end(); iter++) {
+		if (iter->second == getpid())
+			shm_unlink(iter->first.c_str());
+	}
+	pending.clear();
+}
+
+uint64_t SharedYieldSegment::MakeKey(const std::vector<TString>& settings,
+		const std::vector<TString>& input_files) {
+	uint64_t hash = 14695981039346656037ull;
+	uint32_t version = kVersion;
+	HashBytes(hash, &version, sizeof(version));
+	for (unsigned int setting_idx = 0; setting_idx != settings.size();
+			setting_idx++) {
+		HashString(hash, settings[setting_idx]);
+	}
+
+	for (unsigned int file_idx = 0; file_idx != input_files.size();
+			file_idx++) {
+		struct stat file_stat;
+		if (stat(input_files[file_idx].Data(), &file_stat) != 0)
+			return 0;
+		uint64_t identity[] = { uint64_t(file_stat.st_dev),
+				uint64_t(file_stat.st_ino), uint64_t(file_stat.st_size),
+				uint64_t(file_stat.st_mtime) };
+		HashString(hash, input_files[file_idx]);
+		HashBytes(hash, identity, sizeof(identity));
+	}
+	// 0 means no key
+	return (hash != 0) ? hash : 1;
+}
+
+bool SharedYieldSegment::Create() {
+	int fd = shm_open(name_.Data(), O_RDWR | O_CREAT | O_EXCL, 0644);
+	if (fd < 0) {
+		if (errno != EEXIST)
+			std::cout << "SharedYieldSegment::Create - Cannot create " << name_
+					<< ": " << strerror(errno) << std::endl;
+		return false;
+	}
+
+	// The header is there from the start so waiters can check the owner
+	Header header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, kMagic, sizeof(kMagic));
+	header.version = kVersion;
+	header.owner_pid = getpid();
+	header.key = key_;
+	if (ftruncate(fd, sizeof(Header)) != 0
+			|| pwrite(fd, &header, sizeof(header), 0)
+					!= ssize_t(sizeof(header))) {
+		std::cout << "SharedYieldSegment::Create - Cannot write " << name_
+				<< std::endl;
+		close(fd);
+		shm_unlink(name_.Data());
+		return false;
+	}
+	close(fd);
+	is_owner_ = true;
+	is_published_ = false;
+	AddPending(name_);
+	return true;
+}
+
+bool SharedYieldSegment::Reclaim() {
+	std::cout << "SharedYieldSegment::Reclaim - Removing " << name_
+			<< ", its owner did not publish it" << std::endl;
+	shm_unlink(name_.Data());
+	return this->Create();
+}
+
+bool SharedYieldSegment::Publish(const YieldStore& store) {
+	if (!is_owner_) {
+		std::cout << "SharedYieldSegment::Publish - " << name_
+				<< " was not created here" << std::endl;
+		return false;
+	}
+
+	std::string names;
+	for (unsigned int entry = 0; entry != store.GetNEntries(); entry++) {
+		names.append(store.GetName(entry).Data());
+		names.push_back('\0');
+	}
+
+	size_t entries_offset = Align(sizeof(Header));
+	size_t names_offset = entries_offset
+			+ Align(store.GetNEntries() * sizeof(YieldStore::Entry));
+	size_t arena_offset = names_offset + Align(names.size());
+	size_t size = arena_offset + store.GetArenaSize() * sizeof(float);
+
+	int fd = shm_open(name_.Data(), O_RDWR, 0644);
+	if (fd < 0 || ftruncate(fd, size) != 0) {
+		std::cout << "SharedYieldSegment::Publish - Cannot size " << name_
+				<< std::endl;
+		if (fd >= 0)
+			close(fd);
+		shm_unlink(name_.Data());
+		return false;
+	}
+	void* mapping = mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (mapping == MAP_FAILED) {
+		std::cout << "SharedYieldSegment::Publish - Cannot map " << name_
+				<< std::endl;
+		shm_unlink(name_.Data());
+		return false;
+	}
+
+	// The header written by Create keeps state 0 until the end
+	char* base = (char*) mapping;
+	Header* header = (Header*) base;
+	header->n_entries = store.GetNEntries();
+	header->arena_size = store.GetArenaSize();
+	header->names_size = names.size();
+	for (unsigned int entry = 0; entry != store.GetNEntries(); entry++) {
+		memcpy(base + entries_offset + entry * sizeof(YieldStore::Entry),
+				&store.GetEntry(entry), sizeof(YieldStore::Entry));
+	}
+	memcpy(base + names_offset, names.data(), names.size());
+	memcpy(base + arena_offset, store.GetArenaData(),
+			store.GetArenaSize() * sizeof(float));
+	__atomic_store_n(&header->state, 1u, __ATOMIC_RELEASE);
+
+	munmap(mapping, size);
+	is_published_ = true;
+	RemovePending(name_);
+	return true;
+}
+
+// Maps the segment if it is complete. Publish sizes the segment before
+// it sets the state, so the size read after the state is final.
+bool SharedYieldSegment::MapReady(int fd) {
+	struct stat segment_stat;
+	if (fstat(fd, &segment_stat) != 0
+			|| size_t(segment_stat.st_size) < sizeof(Header))
+		return false;
+
+	void* header_mapping = mmap(0, sizeof(Header), PROT_READ, MAP_SHARED, fd,
+			0);
+	if (header_mapping == MAP_FAILED)
+		return false;
+	uint32_t state = __atomic_load_n(&((const Header*) header_mapping)->state,
+			__ATOMIC_ACQUIRE);
+	munmap(header_mapping, sizeof(Header));
+	if (state != 1 || fstat(fd, &segment_stat) != 0)
+		return false;
+
+	size_t size = segment_stat.st_size;
+	void* mapping = mmap(0, size, PROT_READ, MAP_SHARED, fd, 0);
+	if (mapping == MAP_FAILED)
+		return false;
+
+	const Header* header = (const Header*) mapping;
+	if (memcmp(header->magic, kMagic, sizeof(kMagic)) != 0
+			|| header->version != kVersion || header->key != key_) {
+		std::cout << "SharedYieldSegment::MapReady - " << name_
+				<< " is not a version " << kVersion << " segment" << std::endl;
+		munmap(mapping, size);
+		return false;
+	}
+
+	mapping_ = mapping;
+	mapping_size_ = size;
+	return true;
+}
+
+// Only a header with a pid that no longer runs counts, the owner may not
+// have written its header yet
+bool SharedYieldSegment::IsOwnerDead(int fd) const {
+	Header header;
+	if (pread(fd, &header, sizeof(header), 0) != ssize_t(sizeof(header))
+			|| header.owner_pid <= 0)
+		return false;
+	return kill(header.owner_pid, 0) != 0 && errno == ESRCH;
+}
+
+bool SharedYieldSegment::Attach(double timeout) {
+	int fd = shm_open(name_.Data(), O_RDONLY, 0);
+	if (fd < 0)
+		return false;
+
+	// Polls while the owner reads the files
+	const unsigned int poll_us = 50000;
+	double waited = 0.;
+	while (!this->MapReady(fd)) {
+		if (this->IsOwnerDead(fd)) {
+			std::cout << "SharedYieldSegment::Attach - The owner of " << name_
+					<< " is gone" << std::endl;
+			close(fd);
+			return false;
+		}
+		if (waited >= timeout) {
+			std::cout << "SharedYieldSegment::Attach - " << name_
+					<< " not ready after " << timeout << " s" << std::endl;
+			close(fd);
+			return false;
+		}
+		usleep(poll_us);
+		waited += poll_us * 1e-6;
+	}
+	close(fd);
+	return true;
+}
+
+void SharedYieldSegment::View(YieldStore& store) const {
+	const char* base = (const char*) mapping_;
+	const Header* header = (const Header*) base;
+	size_t entries_offset = Align(sizeof(Header));
+	size_t names_offset = entries_offset
+			+ Align(header->n_entries * sizeof(YieldStore::Entry));
+	size_t arena_offset = names_offset + Align(header->names_size);
+
+	std::vector<TString> names;
+	const char* name = base + names_offset;
+	for (uint64_t entry = 0; entry != header->n_entries; entry++) {
+		names.push_back(name);
+		name += strlen(name) + 1;
+	}
+	store.Attach((const float*) (base + arena_offset), header->arena_size,
+			(const YieldStore::Entry*) (base + entries_offset), names);
+}
+
+bool SharedYieldSegment::Remove(uint64_t key) {
+	SharedYieldSegment segment(key);
+	return shm_unlink(segment.GetName().Data()) == 0;
+}
@@ -0,0 +1,112 @@
+/*
+ * SharedYieldSegment.h
+ * POSIX shared memory copy of the merged yield store of a sample, so that
+ * jobs running side by side on a node read and merge the input files
+ * once between them. The first job to ask claims the segment, loads the
+ * sample as usual and publishes its store; the others wait for it and
+ * view the arena in place, read only, without a copy of their own.
+ *
+ * Segments are named /qcdYields_<key>, the key hashes the layout version,
+ * the sample settings and the path, device, inode, size and modification
+ * time of every input file, so any change to the inputs gives a new
+ * segment. Segments outlive the jobs; Remove, or deleting
+ * /dev/shm/qcdYields_*, frees them.
+ *
+ * The header holds the pid of the job that claimed the segment. An owner
+ * that fails before publishing removes the segment on its way out, also
+ * through exit(). One that was killed leaves it behind: the jobs waiting
+ * on it see that the pid is gone, or time out, and Reclaim the segment.
+ *
+ * Layout, all in native byte order, every block 8 byte aligned:
+ *   Header               state is 1 once the segment is complete
+ *   YieldStore::Entry[n_entries]
+ *   names                n_entries names, each null terminated
+ *   arena                float[arena_size]
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef SHAREDYIELDSEGMENT_H_
+#define SHAREDYIELDSEGMENT_H_
+
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+#include "TString.h"
+#include "YieldStore.h"
+
+class SharedYieldSegment {
+
+private:
+	struct Header {
+		char magic[8];
+		uint32_t version;
+		uint32_t state;
+		int32_t owner_pid;
+		uint32_t padding;
+		uint64_t key;
+		uint64_t n_entries;
+		uint64_t arena_size;
+		uint64_t names_size;
+	};
+
+	static const char kMagic[8];
+	static const uint32_t kVersion = 2;
+
+	uint64_t key_;
+	TString name_;
+	bool is_owner_;
+	bool is_published_;
+	void* mapping_;
+	size_t mapping_size_;
+
+	// Holds a mapping, copies would unmap it twice
+	SharedYieldSegment(const SharedYieldSegment&);
+	SharedYieldSegment& operator=(const SharedYieldSegment&);
+
+	bool MapReady(int fd);
+	bool IsOwnerDead(int fd) const;
+	// Claimed but unpublished segments of this process, removed at exit
+	static void AddPending(TString name);
+	static void RemovePending(TString name);
+	static void RemoveAllPending(void);
+	static size_t Align(size_t size) {
+		return (size + 7) & ~size_t(7);
+	}
+
+public:
+	SharedYieldSegment(uint64_t key);
+	// Unmaps the segment, which stays in place for other jobs once
+	// published. A claimed segment that was never published is removed.
+	virtual ~SharedYieldSegment();
+
+	// Hash of the settings and of the identity of every input file. 0 if
+	// a file cannot be found, such samples are not shared.
+	static uint64_t MakeKey(const std::vector<TString>& settings,
+			const std::vector<TString>& input_files);
+
+	TString GetName(void) const {
+		return name_;
+	}
+
+	// Claims the segment, true if it did not exist and this job has to
+	// fill it with Publish
+	bool Create(void);
+	// Writes a store into a claimed segment and marks it complete
+	bool Publish(const YieldStore& store);
+
+	// Waits up to timeout seconds for the segment to be complete and maps
+	// it read only. False if it never was, or as soon as its owner is
+	// found dead.
+	bool Attach(double timeout);
+	// Removes a segment whose owner failed and claims it again, true if
+	// this job has to fill it now. Two jobs reclaiming at once may both
+	// end up owners, the later one then publishes the segment in use.
+	bool Reclaim(void);
+	// Views the attached arena in place, valid while this is alive
+	void View(YieldStore& store) const;
+
+	static bool Remove(uint64_t key);
+};
+
+#endif /* SHAREDYIELDSEGMENT_H_ */
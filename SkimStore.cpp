@@ -0,0 +1,244 @@
+/*
+ * SkimStore.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include "SkimStore.h"
+#include <iostream>
+#include <string>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+const char SkimStore::kMagic[8] = { 'S', 'K', 'I', 'M', 'S', 'T', 'O', 'R' };
+
+SkimStore::SkimStore(TString skim_path) :
+		skim_path_(skim_path), mapping_(0), mapping_size_(0), n_events_(0), met_(
+				0), iso_(0), weight_(0), n_jet_(0), n_tag_(0) {
+	this->Map();
+}
+
+SkimStore::~SkimStore() {
+	if (mapping_ != 0)
+		munmap(mapping_, mapping_size_);
+	mapping_ = 0;
+}
+
+void SkimStore::Map() {
+	int fd = open(skim_path_.Data(), O_RDONLY);
+	if (fd < 0) {
+		std::cout << "SkimStore::Map - Skim NOT found: " << skim_path_
+				<< std::endl;
+		return;
+	}
+
+	struct stat file_stat;
+	if (fstat(fd, &file_stat) != 0
+			|| size_t(file_stat.st_size) < sizeof(Header)) {
+		std::cout << "SkimStore::Map - Skim too short: " << skim_path_
+				<< std::endl;
+		close(fd);
+		return;
+	}
+
+	mapping_size_ = file_stat.st_size;
+	void* mapping = mmap(0, mapping_size_, PROT_READ, MAP_PRIVATE, fd, 0);
+	// The mapping stays valid after the descriptor is closed
+	close(fd);
+	if (mapping == MAP_FAILED) {
+		std::cout << "SkimStore::Map - Cannot map " << skim_path_ << std::endl;
+		return;
+	}
+	// Every column is scanned from start to end
+	madvise(mapping, mapping_size_, MADV_SEQUENTIAL);
+
+	const char* base = (const char*) mapping;
+	const Header* header = (const Header*) base;
+	if (memcmp(header->magic, kMagic, sizeof(kMagic)) != 0
+			|| header->version != kVersion) {
+		std::cout << "SkimStore::Map - Not a version " << kVersion
+				<< " skim: " << skim_path_ << std::endl;
+		munmap(mapping, mapping_size_);
+		return;
+	}
+
+	uint64_t n_events = header->n_events;
+	size_t float_size = Align(n_events * sizeof(float));
+	Layout layout = GetLayout(n_events, header->n_variations,
+			header->names_size);
+
+	if (layout.size != mapping_size_) {
+		std::cout << "SkimStore::Map - Truncated skim: " << skim_path_
+				<< std::endl;
+		munmap(mapping, mapping_size_);
+		return;
+	}
+
+	mapping_ = mapping;
+	n_events_ = n_events;
+	const char* name = base + layout.names;
+	for (uint32_t var_idx = 0; var_idx != header->n_variations; var_idx++) {
+		variation_names_.push_back(name);
+		variation_weights_.push_back(
+				(const float*) (base + layout.variations + var_idx * float_size));
+		name += strlen(name) + 1;
+	}
+	met_ = (const float*) (base + layout.met);
+	iso_ = (const float*) (base + layout.iso);
+	weight_ = (const float*) (base + layout.weight);
+	n_jet_ = (const uint8_t*) (base + layout.n_jet);
+	n_tag_ = (const uint8_t*) (base + layout.n_tag);
+}
+
+SkimStore::Layout SkimStore::GetLayout(uint64_t n_events,
+		uint32_t n_variations, uint64_t names_size) {
+	size_t float_size = Align(n_events * sizeof(float));
+	size_t byte_size = Align(n_events);
+	Layout layout;
+	layout.names = Align(sizeof(Header));
+	layout.met = layout.names + Align(names_size);
+	layout.iso = layout.met + float_size;
+	layout.weight = layout.iso + float_size;
+	layout.variations = layout.weight + float_size;
+	layout.n_jet = layout.variations + n_variations * float_size;
+	layout.n_tag = layout.n_jet + byte_size;
+	layout.size = layout.n_tag + byte_size;
+	return layout;
+}
+
+int SkimStore::FindVariation(TString variation) const {
+	for (unsigned int var_idx = 0; var_idx != variation_names_.size();
+			var_idx++) {
+		if (variation_names_[var_idx] == variation)
+			return var_idx;
+	}
+	return -1;
+}
+
+bool SkimStore::Write(TString skim_path, const SkimColumns& columns,
+		const std::vector<TString>& variation_names) {
+	if (columns.variation_weights.size() != variation_names.size()) {
+		std::cout << "SkimStore::Write - " << variation_names.size()
+				<< " variation names for " << columns.variation_weights.size()
+				<< " weight columns" << std::endl;
+		return false;
+	}
+
+	SkimWriter writer(skim_path, columns.GetNEvents(), variation_names);
+	if (!writer.IsOpen())
+		return false;
+	bool is_ok = writer.WriteRange(0, columns);
+	is_ok &= writer.Close();
+	return is_ok;
+}
+
+SkimWriter::SkimWriter(TString skim_path, uint64_t n_events,
+		const std::vector<TString>& variation_names) :
+		skim_path_(skim_path), fd_(-1), n_events_(n_events), n_variations_(
+				variation_names.size()) {
+	std::string names;
+	for (unsigned int var_idx = 0; var_idx != variation_names.size();
+			var_idx++) {
+		names.append(variation_names[var_idx].Data());
+		names.push_back('\0');
+	}
+	layout_ = SkimStore::GetLayout(n_events, n_variations_, names.size());
+
+	SkimStore::Header header;
+	memcpy(header.magic, SkimStore::kMagic, sizeof(SkimStore::kMagic));
+	header.version = SkimStore::kVersion;
+	header.n_variations = n_variations_;
+	header.n_events = n_events;
+	header.names_size = names.size();
+
+	fd_ = open(skim_path.Data(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd_ < 0) {
+		std::cout << "SkimWriter::SkimWriter - Cannot write " << skim_path
+				<< std::endl;
+		return;
+	}
+	// The padding between the blocks stays zero
+	if (ftruncate(fd_, layout_.size) != 0
+			|| !this->WriteAt(&header, sizeof(header), 0)
+			|| !this->WriteAt(names.data(), names.size(), layout_.names)) {
+		std::cout << "SkimWriter::SkimWriter - Write failed for "
+				<< skim_path << std::endl;
+		close(fd_);
+		fd_ = -1;
+	}
+}
+
+SkimWriter::~SkimWriter() {
+	if (fd_ >= 0)
+		close(fd_);
+}
+
+// pwrite may write less than asked for
+bool SkimWriter::WriteAt(const void* data, size_t size, size_t offset) {
+	const char* bytes = (const char*) data;
+	while (size != 0) {
+		ssize_t written = pwrite(fd_, bytes, size, offset);
+		if (written <= 0)
+			return false;
+		bytes += written;
+		size -= written;
+		offset += written;
+	}
+	return true;
+}
+
+bool SkimWriter::WriteRange(uint64_t first_event, const SkimColumns& columns) {
+	uint64_t n_events = columns.GetNEvents();
+	if (fd_ < 0 || first_event + n_events > n_events_
+			|| columns.variation_weights.size() != n_variations_) {
+		std::cout << "SkimWriter::WriteRange - Events " << first_event
+				<< " to " << (first_event + n_events) << " do not fit "
+				<< skim_path_ << std::endl;
+		return false;
+	}
+
+	size_t float_size = SkimStore::Align(n_events_ * sizeof(float));
+	size_t float_offset = first_event * sizeof(float);
+	size_t n_float_bytes = n_events * sizeof(float);
+	bool is_ok = true;
+	is_ok &= this->WriteAt(columns.met.data(), n_float_bytes,
+			layout_.met + float_offset);
+	is_ok &= this->WriteAt(columns.iso.data(), n_float_bytes,
+			layout_.iso + float_offset);
+	is_ok &= this->WriteAt(columns.weight.data(), n_float_bytes,
+			layout_.weight + float_offset);
+	for (unsigned int var_idx = 0; var_idx != n_variations_; var_idx++) {
+		is_ok &= this->WriteAt(columns.variation_weights[var_idx].data(),
+				n_float_bytes,
+				layout_.variations + var_idx * float_size + float_offset);
+	}
+	is_ok &= this->WriteAt(columns.n_jet.data(), n_events,
+			layout_.n_jet + first_event);
+	is_ok &= this->WriteAt(columns.n_tag.data(), n_events,
+			layout_.n_tag + first_event);
+
+	if (!is_ok) {
+		std::cout << "SkimWriter::WriteRange - Write failed for "
+				<< skim_path_ << std::endl;
+	}
+	return is_ok;
+}
+
+bool SkimWriter::Close() {
+	if (fd_ < 0)
+		return false;
+	bool is_ok = (close(fd_) == 0);
+	fd_ = -1;
+	if (!is_ok) {
+		std::cout << "SkimWriter::Close - Write failed for " << skim_path_
+				<< std::endl;
+		return false;
+	}
+
+	std::cout << "SkimWriter::Close - " << n_events_ << " events written to "
+			<< skim_path_ << std::endl;
+	return true;
+}
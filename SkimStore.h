@@ -0,0 +1,189 @@
+/*
+ * SkimStore.h
+ * Slim columnar copy of the event variables the regions depend on, made
+ * once from the ntuples by EventLoop::Skim and read back through a
+ * read-only memory map by EventLoop::RunSkim, so new cuts only need a
+ * pass over a few narrow arrays instead of the full ntuples.
+ *
+ * Layout, all in native byte order, every block 8 byte aligned:
+ *   Header
+ *   names      variation names, each null terminated
+ *   met        float[n_events]
+ *   etcone20   float[n_events]
+ *   weight     float[n_events], nominal event weight
+ *   weights    float[n_events] for every weight variation
+ *   n_jet      uint8[n_events], clamped to 255
+ *   n_tag      uint8[n_events], clamped to 255
+ * That is 14 bytes per event plus 4 per variation. The columns are kept
+ * uncompressed on purpose, so that they can be scanned straight from the
+ * page cache. Since every offset follows from the number of events, a
+ * SkimWriter puts each range of events straight into place, no column
+ * has to be held whole in memory.
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef SKIMSTORE_H_
+#define SKIMSTORE_H_
+
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+#include "TString.h"
+
+// Columns of a skim in memory, in the order of the events
+struct SkimColumns {
+	std::vector<float> met;
+	std::vector<float> iso;
+	std::vector<float> weight;
+	std::vector<std::vector<float> > variation_weights;
+	std::vector<uint8_t> n_jet;
+	std::vector<uint8_t> n_tag;
+
+	uint64_t GetNEvents(void) const {
+		return met.size();
+	}
+};
+
+class SkimStore {
+
+private:
+	struct Header {
+		char magic[8];
+		uint32_t version;
+		uint32_t n_variations;
+		uint64_t n_events;
+		uint64_t names_size;
+	};
+
+	static const char kMagic[8];
+	static const uint32_t kVersion = 1;
+
+	// Byte offsets of every block in the file, and its total size
+	struct Layout {
+		size_t names;
+		size_t met;
+		size_t iso;
+		size_t weight;
+		size_t variations;
+		size_t n_jet;
+		size_t n_tag;
+		size_t size;
+	};
+	static Layout GetLayout(uint64_t n_events, uint32_t n_variations,
+			uint64_t names_size);
+
+	TString skim_path_;
+	void* mapping_;
+	size_t mapping_size_;
+
+	uint64_t n_events_;
+	std::vector<TString> variation_names_;
+	const float* met_;
+	const float* iso_;
+	const float* weight_;
+	std::vector<const float*> variation_weights_;
+	const uint8_t* n_jet_;
+	const uint8_t* n_tag_;
+
+	// Holds a mapping, copies would unmap it twice
+	SkimStore(const SkimStore&);
+	SkimStore& operator=(const SkimStore&);
+
+	void Map(void);
+	static size_t Align(size_t size) {
+		return (size + 7) & ~size_t(7);
+	}
+
+	friend class SkimWriter;
+
+public:
+	SkimStore(TString skim_path);
+	virtual ~SkimStore();
+
+	bool IsOpen(void) const {
+		return mapping_ != 0;
+	}
+	TString GetSkimPath(void) const {
+		return skim_path_;
+	}
+
+	uint64_t GetNEvents(void) const {
+		return n_events_;
+	}
+	unsigned int GetNVariations(void) const {
+		return variation_names_.size();
+	}
+	TString GetVariationName(unsigned int variation) const {
+		return variation_names_.at(variation);
+	}
+	// Index of a weight variation, -1 if it was not skimmed
+	int FindVariation(TString variation) const;
+
+	const float* GetMet(void) const {
+		return met_;
+	}
+	const float* GetIso(void) const {
+		return iso_;
+	}
+	const float* GetWeight(void) const {
+		return weight_;
+	}
+	const float* GetVariationWeight(unsigned int variation) const {
+		return variation_weights_.at(variation);
+	}
+	const uint8_t* GetNJet(void) const {
+		return n_jet_;
+	}
+	const uint8_t* GetNTag(void) const {
+		return n_tag_;
+	}
+
+	// Skim files are recognised by their extension
+	static bool IsSkimPath(TString path) {
+		return path.EndsWith(".skim");
+	}
+
+	// Writes the columns, one weight column per variation name. Returns
+	// false if the file cannot be written.
+	static bool Write(TString skim_path, const SkimColumns& columns,
+			const std::vector<TString>& variation_names);
+};
+
+// Writes a skim of a known number of events range by range, each range
+// straight to its place in every column
+class SkimWriter {
+
+private:
+	TString skim_path_;
+	int fd_;
+	uint64_t n_events_;
+	unsigned int n_variations_;
+	SkimStore::Layout layout_;
+
+	SkimWriter(const SkimWriter&);
+	SkimWriter& operator=(const SkimWriter&);
+
+	bool WriteAt(const void* data, size_t size, size_t offset);
+
+public:
+	// Creates the file at its full size with the header and names, see
+	// IsOpen
+	SkimWriter(TString skim_path, uint64_t n_events,
+			const std::vector<TString>& variation_names);
+	// Closes the file if Close was not called
+	virtual ~SkimWriter();
+
+	bool IsOpen(void) const {
+		return fd_ >= 0;
+	}
+
+	// Events first_event to first_event + columns.GetNEvents() - 1, false
+	// if they cannot be written. Can be called from several threads at
+	// once for disjoint ranges.
+	bool WriteRange(uint64_t first_event, const SkimColumns& columns);
+	// False if the file cannot be closed
+	bool Close(void);
+};
+
+#endif /* SKIMSTORE_H_ */
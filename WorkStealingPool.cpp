@@ -0,0 +1,133 @@
+/*
+ * WorkStealingPool.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include "WorkStealingPool.h"
+
+namespace {
+const unsigned int kNotAWorker = (unsigned int) -1;
+}
+
+WorkStealingPool::WorkStealingPool(unsigned int n_threads) :
+		n_queued_(0), n_unfinished_(0), next_queue_(0), stop_(false) {
+	if (n_threads == 0)
+		n_threads = std::thread::hardware_concurrency();
+	if (n_threads == 0)
+		n_threads = 1;
+
+	for (unsigned int worker_idx = 0; worker_idx != n_threads; worker_idx++) {
+		queues_.push_back(new WorkerQueue());
+	}
+	for (unsigned int worker_idx = 0; worker_idx != n_threads; worker_idx++) {
+		workers_.push_back(
+				std::thread(&WorkStealingPool::Work, this, worker_idx));
+	}
+}
+
+WorkStealingPool::~WorkStealingPool() {
+	this->Wait();
+	{
+		std::lock_guard<std::mutex> lock(state_mutex_);
+		stop_ = true;
+	}
+	work_cond_.notify_all();
+
+	for (unsigned int worker_idx = 0; worker_idx != workers_.size();
+			worker_idx++) {
+		workers_[worker_idx].join();
+		delete queues_[worker_idx];
+	}
+}
+
+// Index of the pool worker running on this thread
+unsigned int& WorkStealingPool::CurrentWorker() {
+	static thread_local unsigned int current_worker = kNotAWorker;
+	return current_worker;
+}
+
+void WorkStealingPool::Submit(Task task) {
+	unsigned int queue_idx = CurrentWorker();
+	{
+		std::lock_guard<std::mutex> lock(state_mutex_);
+		if (queue_idx >= queues_.size()) {
+			queue_idx = next_queue_;
+			next_queue_ = (next_queue_ + 1) % queues_.size();
+		}
+		n_unfinished_++;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(queues_[queue_idx]->mutex);
+		queues_[queue_idx]->tasks.push_back(task);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(state_mutex_);
+		n_queued_++;
+	}
+	work_cond_.notify_one();
+}
+
+void WorkStealingPool::Wait() {
+	std::unique_lock<std::mutex> lock(state_mutex_);
+	while (n_unfinished_ != 0) {
+		done_cond_.wait(lock);
+	}
+}
+
+// Own queue from the back, then the other queues from the front
+bool WorkStealingPool::PopTask(unsigned int worker_index, Task& task) {
+	{
+		WorkerQueue* own = queues_[worker_index];
+		std::lock_guard<std::mutex> lock(own->mutex);
+		if (!own->tasks.empty()) {
+			task = own->tasks.back();
+			own->tasks.pop_back();
+			return true;
+		}
+	}
+
+	for (unsigned int offset = 1; offset != queues_.size(); offset++) {
+		WorkerQueue* victim = queues_[(worker_index + offset) % queues_.size()];
+		std::lock_guard<std::mutex> lock(victim->mutex);
+		if (!victim->tasks.empty()) {
+			task = victim->tasks.front();
+			victim->tasks.pop_front();
+			return true;
+		}
+	}
+	return false;
+}
+
+void WorkStealingPool::Work(unsigned int worker_index) {
+	CurrentWorker() = worker_index;
+
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(state_mutex_);
+			while (!stop_ && n_queued_ == 0) {
+				work_cond_.wait(lock);
+			}
+			if (stop_ && n_queued_ == 0)
+				return;
+			// Claim one of the queued tasks before looking for it
+			n_queued_--;
+		}
+
+		Task task;
+		while (!this->PopTask(worker_index, task)) {
+			// The claimed task is still being pushed by Submit
+			std::this_thread::yield();
+		}
+		task();
+
+		{
+			std::lock_guard<std::mutex> lock(state_mutex_);
+			n_unfinished_--;
+			if (n_unfinished_ == 0)
+				done_cond_.notify_all();
+		}
+	}
+}
@@ -0,0 +1,68 @@
+/*
+ * WorkStealingPool.h
+ * Fixed set of worker threads, each with its own task deque. Workers
+ * run their own tasks newest first and steal the oldest task of another
+ * worker when they run dry, so a few long tasks (the systematic
+ * variations) do not leave the other threads idle.
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef WORKSTEALINGPOOL_H_
+#define WORKSTEALINGPOOL_H_
+
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+class WorkStealingPool {
+
+public:
+	typedef std::function<void()> Task;
+
+private:
+	struct WorkerQueue {
+		std::deque<Task> tasks;
+		std::mutex mutex;
+	};
+
+	std::vector<WorkerQueue*> queues_;
+	std::vector<std::thread> workers_;
+
+	// Guards the counters below and the sleeping workers
+	std::mutex state_mutex_;
+	std::condition_variable work_cond_;
+	std::condition_variable done_cond_;
+	unsigned int n_queued_;
+	unsigned int n_unfinished_;
+	unsigned int next_queue_;
+	bool stop_;
+
+	void Work(unsigned int worker_index);
+	bool PopTask(unsigned int worker_index, Task& task);
+
+	static unsigned int& CurrentWorker(void);
+
+	WorkStealingPool(const WorkStealingPool&);
+	WorkStealingPool& operator=(const WorkStealingPool&);
+
+public:
+	// n_threads = 0 uses one thread per core
+	WorkStealingPool(unsigned int n_threads = 0);
+	virtual ~WorkStealingPool();
+
+	// Tasks submitted from a worker go to its own queue
+	void Submit(Task task);
+	// Blocks until every submitted task, including nested ones, has run.
+	// Not to be called from inside a task.
+	void Wait(void);
+
+	unsigned int GetNThreads(void) const {
+		return workers_.size();
+	}
+};
+
+#endif /* WORKSTEALINGPOOL_H_ */
@@ -0,0 +1,103 @@
+/*
+ * YieldStore.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include "YieldStore.h"
+
+#include <iostream>
+#include <stdlib.h>
+
+YieldStore::YieldStore() :
+		attached_(0), attached_size_(0) {
+}
+
+YieldStore::~YieldStore() {
+}
+
+void YieldStore::Reserve(unsigned int n_bins) {
+	arena_.reserve(arena_.size() + 3 * size_t(n_bins));
+}
+
+void YieldStore::Clear() {
+	arena_.clear();
+	attached_ = 0;
+	attached_size_ = 0;
+	entries_.clear();
+	names_.clear();
+	lookup_.clear();
+}
+
+void YieldStore::Attach(const float* arena, size_t n_floats,
+		const Entry* entries, const std::vector<TString>& names) {
+	this->Clear();
+	attached_ = arena;
+	attached_size_ = n_floats;
+	entries_.assign(entries, entries + names.size());
+	names_ = names;
+	for (unsigned int entry = 0; entry != names_.size(); entry++) {
+		lookup_[names_[entry]] = entry;
+	}
+}
+
+int YieldStore::Add(TString histo_name, const double* contents,
+		const double* sumw2, const double* edges, unsigned int n_bins,
+		double scale) {
+	if (attached_ != 0) {
+		std::cout << "YieldStore::Add - Cannot add " << histo_name
+				<< " to an attached store" << std::endl;
+		exit(-1);
+	}
+
+	Entry entry;
+	entry.offset = arena_.size();
+	entry.n_bins = n_bins;
+	entry.padding = 0;
+
+	for (unsigned int bin = 0; bin != n_bins; bin++) {
+		arena_.push_back(contents[bin] * scale);
+	}
+	for (unsigned int bin = 0; bin != n_bins; bin++) {
+		arena_.push_back(sumw2[bin] * scale * scale);
+	}
+	for (unsigned int bin = 0; bin + 1 < n_bins; bin++) {
+		arena_.push_back(edges[bin]);
+	}
+
+	int entry_index = entries_.size();
+	entries_.push_back(entry);
+	names_.push_back(histo_name);
+	lookup_[histo_name] = entry_index;
+	return entry_index;
+}
+
+int YieldStore::Find(TString histo_name) const {
+	std::map<TString, int>::const_iterator found = lookup_.find(histo_name);
+	return (found != lookup_.end()) ? found->second : -1;
+}
+
+double YieldStore::Integral(int entry, int first_bin, int last_bin) const {
+	const float* contents = this->GetArena() + entries_[entry].offset;
+	double sum = 0.;
+	for (int bin = first_bin; bin <= last_bin; bin++) {
+		sum += contents[bin];
+	}
+	return sum;
+}
+
+double YieldStore::IntegralSumw2(int entry, int first_bin,
+		int last_bin) const {
+	const float* sumw2 = this->GetArena() + entries_[entry].offset
+			+ entries_[entry].n_bins;
+	double sum = 0.;
+	for (int bin = first_bin; bin <= last_bin; bin++) {
+		sum += sumw2[bin];
+	}
+	return sum;
+}
+
+size_t YieldStore::GetNBytes() const {
+	return arena_.capacity() * sizeof(float)
+			+ entries_.capacity() * sizeof(Entry);
+}
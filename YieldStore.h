@@ -0,0 +1,119 @@
+/*
+ * YieldStore.h
+ * Compact copy of the region histograms of a sample. Bin contents, sumw2
+ * and bin edges of every histogram are rounded to float and kept one
+ * after the other in a single arena, with a small index on the side, so
+ * a histogram costs 12 bytes per bin and no object header. Sums over bins
+ * are accumulated in double.
+ *
+ * Entries refer to the arena by offset, so the arena can be copied or
+ * written out as one block, or viewed in place in memory owned by
+ * someone else, see SharedYieldSegment.
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef YIELDSTORE_H_
+#define YIELDSTORE_H_
+
+#include <vector>
+#include <map>
+#include <stddef.h>
+#include <stdint.h>
+#include "TString.h"
+
+class YieldStore {
+
+public:
+	// Position of one histogram in the arena: n_bins contents, then n_bins
+	// sumw2, then the n_bins - 1 edges
+	struct Entry {
+		uint64_t offset;
+		uint32_t n_bins;
+		uint32_t padding;
+	};
+
+private:
+	std::vector<float> arena_;
+	// Arena viewed in place instead of arena_, not owned
+	const float* attached_;
+	size_t attached_size_;
+	std::vector<Entry> entries_;
+	std::vector<TString> names_;
+	std::map<TString, int> lookup_;
+
+	const float* GetArena(void) const {
+		return (attached_ != 0) ? attached_ : arena_.data();
+	}
+
+public:
+	YieldStore(void);
+	virtual ~YieldStore();
+
+	// Room for n_bins more bins, avoids growing the arena histogram by
+	// histogram
+	void Reserve(unsigned int n_bins);
+	void Clear(void);
+
+	// Copies a histogram including under- and overflow bins. edges holds
+	// n_bins - 1 values, the low edges of bins 1 to n_bins - 2 and the up
+	// edge of the last one. The contents are multiplied by scale and sumw2
+	// by scale^2 before rounding. Returns the entry index.
+	int Add(TString histo_name, const double* contents, const double* sumw2,
+			const double* edges, unsigned int n_bins, double scale = 1.);
+
+	// Views n_floats floats of arena in place, with the given entries. The
+	// arena has to outlive the store and its copies; nothing can be added
+	// until the store is cleared.
+	void Attach(const float* arena, size_t n_floats, const Entry* entries,
+			const std::vector<TString>& names);
+	bool IsAttached(void) const {
+		return attached_ != 0;
+	}
+
+	// Entry index of a histogram, -1 if it was never added
+	int Find(TString histo_name) const;
+	TString GetName(int entry) const {
+		return names_[entry];
+	}
+	const Entry& GetEntry(int entry) const {
+		return entries_[entry];
+	}
+
+	// The whole arena, for writing it out as one block
+	const float* GetArenaData(void) const {
+		return this->GetArena();
+	}
+	size_t GetArenaSize(void) const {
+		return (attached_ != 0) ? attached_size_ : arena_.size();
+	}
+
+	unsigned int GetNEntries(void) const {
+		return entries_.size();
+	}
+	unsigned int GetNBins(int entry) const {
+		return entries_[entry].n_bins;
+	}
+	double GetBinContent(int entry, int bin) const {
+		return this->GetArena()[entries_[entry].offset + bin];
+	}
+	double GetBinSumw2(int entry, int bin) const {
+		return this->GetArena()[entries_[entry].offset + entries_[entry].n_bins
+				+ bin];
+	}
+	// Edge between bins bin and bin + 1, for bin = 0 to n_bins - 2
+	double GetEdge(int entry, int bin) const {
+		return this->GetArena()[entries_[entry].offset
+				+ 2 * entries_[entry].n_bins + bin];
+	}
+
+	// Sums over bins first_bin to last_bin, both included
+	double Integral(int entry, int first_bin, int last_bin) const;
+	double IntegralSumw2(int entry, int first_bin, int last_bin) const;
+
+	// Bytes held by the arena and the index, an attached arena is not
+	// counted
+	size_t GetNBytes(void) const;
+};
+
+#endif /* YIELDSTORE_H_ */
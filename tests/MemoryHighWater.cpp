@@ -0,0 +1,129 @@
+/*
+ * MemoryHighWater.cpp
+ * Memory regression test of the batch loop: DoABCD and DoRSMT drivers
+ * are built, read and deleted over and over on one sample set, as a
+ * long batch or daemon process would, under a counting allocator. Once
+ * the first round has filled the reader cache, the bytes still
+ * allocated must stay flat however many rounds follow. The peak RSS of
+ * the process is printed for reference.
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include <new>
+#include <atomic>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <stdlib.h>
+#include "DoABCD.h"
+#include "DoRSMT.h"
+#include "SampleSet.h"
+#include "TestSamples.h"
+
+namespace {
+
+// Allocated bytes and blocks not freed yet, all threads together
+std::atomic<long long> live_bytes(0);
+std::atomic<long long> live_blocks(0);
+
+// Room for the size in front of every block, keeps the alignment of new
+const size_t kHeaderSize = 16;
+
+const int kNRounds = 1000;
+// Allowed growth over all rounds, far below one driver per round
+const long long kSlackBytes = 64 * 1024;
+
+// One round of the batch loop, every configuration of the tables
+double RunRound(SampleSet& samples) {
+	const char* modes[] = { "pretag", "tag" };
+	double sum = 0.;
+	for (int mode_idx = 0; mode_idx != 2; mode_idx++) {
+		for (int jet_bin = 1; jet_bin != 5; jet_bin++) {
+			bool is_inclusive = (jet_bin >= 3);
+			DoABCD abcd(modes[mode_idx], is_inclusive, jet_bin, 1, samples);
+			sum += abcd.getNdEstimate() + abcd.getNdError()
+					+ abcd.getNdSystError();
+		}
+	}
+	for (int jet_bin = 1; jet_bin != 5; jet_bin++) {
+		DoRSMT rsmt(jet_bin, false, 1, samples);
+		sum += rsmt.GetTagEstimate() + rsmt.GetTagEstimateStatError()
+				+ rsmt.GetTagEstimateSystError();
+	}
+	return sum;
+}
+
+// VmHWM of /proc/self/status in kB, 0 where there is none
+long GetPeakRss(void) {
+	std::ifstream status("/proc/self/status");
+	std::string line;
+	while (std::getline(status, line)) {
+		if (line.compare(0, 6, "VmHWM:") == 0)
+			return atol(line.c_str() + 6);
+	}
+	return 0;
+}
+
+} // End anonymous namespace
+
+// The array, nothrow and sized forms all end up here by default
+void* operator new(size_t size) {
+	char* block = (char*) malloc(size + kHeaderSize);
+	if (block == 0)
+		throw std::bad_alloc();
+	*(size_t*) block = size;
+	live_bytes += size;
+	live_blocks++;
+	return block + kHeaderSize;
+}
+
+void operator delete(void* pointer) noexcept {
+	if (pointer == 0)
+		return;
+	char* block = (char*) pointer - kHeaderSize;
+	live_bytes -= *(size_t*) block;
+	live_blocks--;
+	free(block);
+}
+
+int main() {
+	SampleCollection collection = MakeTestSamples();
+	int status = 0;
+	{
+		SampleSet samples(collection);
+
+		// Readers, yield tables and ROOT's own caches are built once
+		double reference = RunRound(samples);
+		long long start_bytes = live_bytes;
+		long long start_blocks = live_blocks;
+
+		int bad_round = -1;
+		for (int round = 0; round != kNRounds && bad_round < 0; round++) {
+			if (RunRound(samples) != reference)
+				bad_round = round;
+		}
+
+		if (bad_round >= 0) {
+			std::cout << "MemoryHighWater - FAILED, round " << bad_round
+					<< " gave another result than the first" << std::endl;
+			status = 1;
+		}
+
+		long long growth = live_bytes - start_bytes;
+		std::cout << "MemoryHighWater - " << kNRounds << " rounds, "
+				<< growth << " bytes in " << (live_blocks - start_blocks)
+				<< " blocks more, peak RSS " << GetPeakRss() << " kB"
+				<< std::endl;
+		if (growth > kSlackBytes) {
+			std::cout << "MemoryHighWater - FAILED, memory grows with the "
+					<< "number of estimates" << std::endl;
+			status = 1;
+		}
+	}
+	DeleteTestSamples(collection);
+
+	if (status == 0)
+		std::cout << "MemoryHighWater - OK" << std::endl;
+	return status;
+}
@@ -0,0 +1,176 @@
+/*
+ * SharedDriverStress.cpp
+ * Thread-safety stress test: many threads read one set of samples and
+ * one DoABCD and DoRSMT driver at once, and every value they read has
+ * to match a single-threaded run on an identical set. The first phase
+ * races the lazy paths of DataSample (the rescale at load, the yield
+ * table, the data sample of the contaminations, the region histograms
+ * rebuilt by GetHistos against the lookups of GetRegionCube) and the
+ * reader cache of SampleSet, the second the shifted and pretag drivers
+ * built on first use. Best run under -fsanitize=thread as well.
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <iostream>
+#include "DoABCD.h"
+#include "DoRSMT.h"
+#include "SampleSet.h"
+#include "AbcdBase.h"
+#include "TestSamples.h"
+
+namespace {
+
+const int kNThreads = 16;
+const int kNIterations = 200;
+
+std::atomic<int> n_waiting(0);
+std::atomic<int> n_mismatches(0);
+
+// Releases every thread at once, so the first calls really race
+void WaitForAll(void) {
+	n_waiting++;
+	while (n_waiting < kNThreads) {
+		std::this_thread::yield();
+	}
+}
+
+void Check(double value, double expected) {
+	if (value != expected)
+		n_mismatches++;
+}
+
+// Normalisation changed after the bins were set, so the first getter
+// of every MC sample rescales it
+SampleCollection MakeRescaledSamples(void) {
+	SampleCollection samples = MakeTestSamples();
+	SampleCollection::iterator iter = samples.begin();
+	for (; iter != samples.end(); iter++) {
+		if (!SampleSet::IsData(iter->first))
+			iter->second->SetNormalisation(2., 1.1, 4., 1.5);
+	}
+	return samples;
+}
+
+// Everything the threads read, in a fixed order
+std::vector<double> ReadSamples(const SampleCollection& samples,
+		SampleSet& sample_set) {
+	std::vector<double> values;
+	SampleCollection::const_iterator iter = samples.begin();
+	for (; iter != samples.end(); iter++) {
+		const DataSample* sample = iter->second;
+		// Looks up the histograms GetHistos adds on another thread
+		for (int mode_idx = 0; mode_idx != 2; mode_idx++) {
+			TString mode = DataSample::GetModes().at(mode_idx);
+			values.push_back(sample->GetRegionCube(mode) != 0);
+			std::vector<TH1D*> histos = sample->GetHistos(mode);
+			for (unsigned int region = 0; region != histos.size(); region++) {
+				values.push_back(histos[region]->GetBinContent(4));
+			}
+		}
+		for (int region = 0; region != 4; region++) {
+			values.push_back(sample->GetYield("tag", region, 3, true));
+			values.push_back(sample->GetYieldError("pretag", region, 2, false));
+			values.push_back(
+					sample->GetContamination("pretag", region, 1, false));
+		}
+		values.push_back(
+				sample->GetYieldTable()->GetYield(0, AbcdBase::B, 2, 9));
+	}
+	for (int jet_bin = 1; jet_bin != 5; jet_bin++) {
+		DoABCD abcd("tag", false, jet_bin, 1, sample_set);
+		values.push_back(abcd.getNdEstimate());
+		values.push_back(abcd.getNdError());
+	}
+	return values;
+}
+
+std::vector<double> ReadDrivers(const DoABCD& abcd, const DoRSMT& rsmt) {
+	std::vector<double> values;
+	values.push_back(abcd.getNdEstimate());
+	values.push_back(abcd.getNdError());
+	values.push_back(abcd.getNdSystError());
+	values.push_back(rsmt.GetRsmtWgt());
+	values.push_back(rsmt.GetRsmtWgtSystErr());
+	values.push_back(rsmt.GetPretagEstimate());
+	values.push_back(rsmt.GetTagEstimate());
+	values.push_back(rsmt.GetTagEstimateSystError());
+	values.push_back(rsmt.GetTagEstimateStatError());
+	return values;
+}
+
+void CheckAll(const std::vector<double>& values,
+		const std::vector<double>& expected) {
+	if (values.size() != expected.size()) {
+		n_mismatches++;
+		return;
+	}
+	for (unsigned int value_idx = 0; value_idx != values.size(); value_idx++) {
+		Check(values[value_idx], expected[value_idx]);
+	}
+}
+
+// Runs body on every thread, released together
+template<class Body>
+void RunThreads(Body body) {
+	n_waiting = 0;
+	std::vector<std::thread> threads;
+	for (int thread_idx = 0; thread_idx != kNThreads; thread_idx++) {
+		threads.push_back(std::thread([&body]() {
+			WaitForAll();
+			for (int iteration = 0; iteration != kNIterations; iteration++) {
+				body();
+			}
+		}));
+	}
+	for (unsigned int thread_idx = 0; thread_idx != threads.size();
+			thread_idx++) {
+		threads[thread_idx].join();
+	}
+}
+
+} // End anonymous namespace
+
+int main() {
+	SampleCollection reference_samples = MakeRescaledSamples();
+	SampleCollection shared_samples = MakeRescaledSamples();
+	int n_sample_mismatches = 0;
+	{
+		SampleSet reference_set(reference_samples);
+		SampleSet shared_set(shared_samples);
+
+		std::vector<double> expected = ReadSamples(reference_samples,
+				reference_set);
+		RunThreads([&]() {
+			CheckAll(ReadSamples(shared_samples, shared_set), expected);
+		});
+		n_sample_mismatches = n_mismatches;
+
+		DoABCD reference_abcd("tag", true, 3, 1, reference_set);
+		DoRSMT reference_rsmt(3, true, 1, reference_set);
+		expected = ReadDrivers(reference_abcd, reference_rsmt);
+
+		// Built here, read for the first time by all threads at once
+		DoABCD shared_abcd("tag", true, 3, 1, shared_set);
+		DoRSMT shared_rsmt(3, true, 1, shared_set);
+		RunThreads([&]() {
+			CheckAll(ReadDrivers(shared_abcd, shared_rsmt), expected);
+		});
+	}
+	DeleteTestSamples(reference_samples);
+	DeleteTestSamples(shared_samples);
+
+	std::cout << "SharedDriverStress - " << kNThreads << " threads x "
+			<< kNIterations << " iterations, " << n_sample_mismatches
+			<< " sample and " << (n_mismatches - n_sample_mismatches)
+			<< " driver mismatches" << std::endl;
+	if (n_mismatches != 0) {
+		std::cout << "SharedDriverStress - FAILED" << std::endl;
+		return 1;
+	}
+	std::cout << "SharedDriverStress - OK" << std::endl;
+	return 0;
+}
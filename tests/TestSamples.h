@@ -0,0 +1,78 @@
+/*
+ * TestSamples.h
+ * In-memory data and MC samples with fixed region yields, so the tests
+ * run without any input files. Yields fall with the jet multiplicity
+ * and rise from region A to D, the MC samples are a few percent of the
+ * data in every bin.
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef TESTSAMPLES_H_
+#define TESTSAMPLES_H_
+
+#include <map>
+#include <string>
+#include <vector>
+#include <math.h>
+#include "TH1D.h"
+#include "DataSample.h"
+#include "SampleSet.h"
+
+// Owned by the caller, delete with DeleteTestSamples
+inline SampleCollection MakeTestSamples(void) {
+	TH1::AddDirectory(false);
+	const char* modes[] = { "pretag", "tag" };
+	std::vector<std::string> names = SampleSet::GetDefaultSamples();
+
+	SampleCollection samples;
+	for (unsigned int sample_idx = 0; sample_idx != names.size();
+			sample_idx++) {
+		DataSample* sample = new DataSample(names.at(sample_idx));
+		double sample_scale = SampleSet::IsData(names.at(sample_idx)) ?
+				1. : 0.01 * sample_idx;
+
+		std::map<TString, TH1*> histos;
+		for (int mode_idx = 0; mode_idx != 2; mode_idx++) {
+			double mode_scale = (mode_idx == 0) ? 1. : 0.3;
+			for (int region = 0; region != 4; region++) {
+				TString histo_name = sample->GetRegionHistoName(
+						modes[mode_idx], region);
+				// Bin n + 1 holds n jets
+				TH1D* histo = new TH1D(histo_name, histo_name, 10, -0.5, 9.5);
+				for (int bin = 1; bin != 11; bin++) {
+					double yield = sample_scale * mode_scale * 1000.
+							* (region + 1) / bin;
+					histo->SetBinContent(bin, yield);
+					histo->SetBinError(bin, sqrt(yield));
+				}
+				histos[histo_name] = histo;
+			}
+		}
+		sample->SetRegionHistos(histos);
+
+		std::map<TString, TH1*>::iterator iter = histos.begin();
+		for (; iter != histos.end(); iter++) {
+			delete iter->second;
+		}
+		samples[names.at(sample_idx)] = sample;
+	}
+
+	// The MC samples take their contaminations from this data
+	DataSample* data = samples["dataAllEgamma"];
+	SampleCollection::iterator iter = samples.begin();
+	for (; iter != samples.end(); iter++) {
+		iter->second->SetDataSample(data);
+	}
+	return samples;
+}
+
+inline void DeleteTestSamples(SampleCollection& samples) {
+	SampleCollection::iterator iter = samples.begin();
+	for (; iter != samples.end(); iter++) {
+		delete iter->second;
+	}
+	samples.clear();
+}
+
+#endif /* TESTSAMPLES_H_ */
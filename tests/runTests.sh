@@ -0,0 +1,32 @@
+#!/bin/bash
+# Builds the library and every test driver in tests/ against it, then
+# runs them. Needs ROOT 6, run from anywhere:
+#   ./tests/runTests.sh
+
+cd "$(dirname "$0")/.." || exit 1
+BUILD=tests/build
+mkdir -p $BUILD
+
+./MakeDictionary.sh || exit 1
+
+echo Building libqcdEstimation.so
+g++ -std=c++11 -O2 -fPIC -shared -I. $(root-config --cflags) \
+	*.cpp qcdEstimationDict.C $(root-config --libs) -pthread -lrt \
+	-o $BUILD/libqcdEstimation.so || exit 1
+
+failed=0
+for test_file in tests/*.cpp; do
+	test_name=$(basename $test_file .cpp)
+	echo Building $test_name
+	g++ -std=c++11 -O2 -I. -Itests $(root-config --cflags) $test_file \
+		-L$BUILD -lqcdEstimation -Wl,-rpath,$PWD/$BUILD \
+		$(root-config --libs) -pthread -lrt -o $BUILD/$test_name || exit 1
+	echo Running $test_name
+	$BUILD/$test_name || failed=1
+done
+
+if [ $failed -ne 0 ]; then
+	echo "Some tests FAILED"
+	exit 1
+fi
+echo "Done! :-)"